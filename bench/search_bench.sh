@@ -0,0 +1,52 @@
+#!/bin/sh
+# Measure the throughput of 'pelf --search' over a synthetic ELF object.
+#
+# The object has a single loaded section holding BENCH_SIZE_MB of repeated
+# English text, so the results are reproducible on any machine with GNU ld:
+# -> rare first byte: the pattern starts with '#', which never occurs, so the
+#    scan is pure memchr()
+# -> frequent first byte: the pattern starts with 'e', which occurs about every
+#    11 bytes, so almost every candidate needs a memcmp()
+#
+# Usage: sh bench/search_bench.sh [path/to/pelf]
+
+set -e
+
+PELF="${1:-./pelf}"
+SIZE_MB="${BENCH_SIZE_MB:-256}"
+RUNS="${BENCH_RUNS:-5}"
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Build the input: 'ld -b binary' wraps the blob in an allocated .data section
+yes "the quick brown fox jumps over the lazy dog" |
+    head -c "$((SIZE_MB * 1024 * 1024))" >"$WORK_DIR/blob"
+(cd "$WORK_DIR" && ld -r -b binary blob -o blob.o)
+
+# Print the best of RUNS runs in GB/s (the first run also warms the page cache)
+bench_pattern() {
+    label="$1"
+    shift
+
+    best_ns=""
+    for _ in $(seq "$RUNS"); do
+        start_ns="$(date +%s%N)"
+        "$PELF" "$@" "$WORK_DIR/blob.o" >/dev/null
+        end_ns="$(date +%s%N)"
+        run_ns=$((end_ns - start_ns))
+
+        if [ -z "$best_ns" ] || [ "$run_ns" -lt "$best_ns" ]; then
+            best_ns="$run_ns"
+        fi
+    done
+
+    awk -v label="$label" -v bytes="$((SIZE_MB * 1024 * 1024))" \
+        -v ns="$best_ns" 'BEGIN {
+            printf "%-22s %8.2f ms  %6.2f GB/s\n", label, ns / 1e6, bytes / ns
+        }'
+}
+
+echo "Searching $SIZE_MB MB, best of $RUNS runs:"
+bench_pattern "rare first byte" --search "#no-such-secret"
+bench_pattern "frequent first byte" --search "eXq"
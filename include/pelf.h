@@ -9,8 +9,55 @@
 #define MAGIC_BYTE_COUNT 4
 #define SHN_UNDEF 0
 #define SHN_XINDEX 0xffff
+#define PN_XNUM 0xffff
 #define NUM_SEC_FLAGS 14
 #define NUM_SEG_FLAGS 3
+#define ET_EXEC 2
+#define ET_DYN 3
+#define SHT_STRTAB 0x3
+#define SHT_DYNAMIC 0x6
+#define SHT_NOBITS 0x8
+#define SHT_DYNSYM 0x0B
+#define PT_LOAD 0x1
+#define PT_INTERP 0x3
+#define PT_DYNAMIC 0x2
+#define PT_GNU_STACK 0x6474e551
+#define PT_GNU_RELRO 0x6474e552
+#define PT_GNU_PROPERTY 0x6474e553
+#define PF_X 0x1
+#define SHF_ALLOC 0x2
+#define SHT_GNU_VERDEF 0x6ffffffd
+#define SHT_GNU_VERNEED 0x6ffffffe
+#define SHT_GNU_VERSYM 0x6fffffff
+#define VER_FLG_BASE 0x1
+#define VERSYM_HIDDEN 0x8000
+#define VERSYM_NUM_IDX 0x8000 // Version indices without the hidden bit
+#define MAX_VERSION_RULES 16
+#define NUM_DYN_VER_SEC 4 // Stand-in sections built from the dynamic segment
+#define MAX_JOBS 1024
+#define DT_NULL 0
+#define DT_NEEDED 1
+#define DT_HASH 4
+#define DT_STRTAB 5
+#define DT_SYMTAB 6
+#define DT_STRSZ 10
+#define DT_SYMENT 11
+#define DT_RPATH 15
+#define DT_BIND_NOW 24
+#define DT_FLAGS 30
+#define DT_RUNPATH 29
+#define DT_GNU_HASH 0x6ffffef5
+#define DT_VERSYM 0x6ffffff0
+#define DT_FLAGS_1 0x6ffffffb
+#define DT_VERNEED 0x6ffffffe
+#define DT_VERNEEDNUM 0x6fffffff
+#define DF_BIND_NOW 0x8
+#define DF_1_NOW 0x1
+#define DF_1_PIE 0x08000000
+#define NT_GNU_PROPERTY_TYPE_0 5
+#define GNU_PROPERTY_X86_FEATURE_1_AND 0xc0000002
+#define GNU_PROPERTY_X86_FEATURE_1_IBT 0x1
+#define GNU_PROPERTY_X86_FEATURE_1_SHSTK 0x2
 const char *ELF_MAGIC_BYTES = "\x7F"
                               "ELF";
 const uint64_t SEC_FLAG_VAL[14] = {0x1,       0x2,      0x4,        0x10,
@@ -81,12 +128,221 @@ typedef struct {
     };
 } elf64_dyn;
 
+// 64-bit ELF symbol table entry
+typedef struct {
+    uint32_t st_name;
+    unsigned char st_info;
+    unsigned char st_other;
+    uint16_t st_shndx;
+    uint64_t st_value;
+    uint64_t st_size;
+} elf64_sym;
+
+// 64-bit ELF version definition ('.gnu.version_d' entry)
+typedef struct {
+    uint16_t vd_version;
+    uint16_t vd_flags;
+    uint16_t vd_ndx;
+    uint16_t vd_cnt;
+    uint32_t vd_hash;
+    uint32_t vd_aux;
+    uint32_t vd_next;
+} elf64_verdef;
+
+// 64-bit ELF version definition name
+typedef struct {
+    uint32_t vda_name;
+    uint32_t vda_next;
+} elf64_verdaux;
+
+// 64-bit ELF version requirement ('.gnu.version_r' entry), one per library
+typedef struct {
+    uint16_t vn_version;
+    uint16_t vn_cnt;
+    uint32_t vn_file;
+    uint32_t vn_aux;
+    uint32_t vn_next;
+} elf64_verneed;
+
+// 64-bit ELF required version of a library
+typedef struct {
+    uint32_t vna_hash;
+    uint16_t vna_flags;
+    uint16_t vna_other;
+    uint32_t vna_name;
+    uint32_t vna_next;
+} elf64_vernaux;
+
+// 64-bit ELF note header (followed by the name and the descriptor)
+typedef struct {
+    uint32_t n_namesz;
+    uint32_t n_descsz;
+    uint32_t n_type;
+} elf64_nhdr;
+
+// Security hardening properties of a 64-bit ELF file
+typedef struct {
+    uint16_t e_type;
+    bool has_relro;
+    bool has_bind_now;
+    bool has_pie_flag;
+    bool has_interp;
+    bool has_gnu_stack;
+    bool has_exec_stack;
+    bool has_canary;
+    uint64_t num_fortified;
+    bool has_ibt;
+    bool has_shstk;
+    char *rpath;   // NULL if absent
+    char *runpath; // NULL if absent
+} elf64_checksec;
+
+// "At most PREFIX_x.y.z" rule for required symbol versions
+typedef struct {
+    char *max_version_name; // E.g. "GLIBC_2.28"
+    size_t prefix_len;      // Length of "GLIBC"
+    uint64_t max_version_key;
+} elf64_version_rule;
+
+// Interned symbol version name, decoded once against the rules
+typedef struct {
+    char *name; // NULL if the slot is empty
+    uint32_t hash;
+    int rule_idx; // -1 if no rule applies
+    uint64_t version_key;
+} elf64_version_entry;
+
+// Required symbol version that breaks a rule
+typedef struct {
+    uint16_t ver_idx; // Index used by '.gnu.version'
+    int rule_idx;
+    const char *version_name;
+    const char *lib_name;
+    uint64_t first_sym; // Position of the symbols that need it
+    uint64_t num_syms;
+} elf64_version_violation;
+
+// Symbol version policy and the version names seen so far
+typedef struct {
+    elf64_version_rule rule_arr[MAX_VERSION_RULES];
+    int num_rules;
+    elf64_version_entry *entry_arr;
+    uint64_t entry_cap; // Power of 2
+    uint64_t num_entries;
+} elf64_version_policy;
+
+// Command line options
+typedef struct {
+    bool checksec_mode;
+    bool watch_mode;
+    unsigned char *search_pattern; // NULL if not searching
+    size_t search_pattern_size;
+    int num_jobs;
+    elf64_version_policy version_policy;
+} pelf_options;
+
+// Cached header tables of a watched 64-bit ELF file
+typedef struct {
+    uint64_t file_dev;
+    uint64_t file_ino;
+    uint64_t file_size;
+    uint64_t file_mtime_ns;
+    elf64_hdr file_hdr;
+    uint64_t num_sec;
+    elf64_shdr *sec_hdr_arr; // NULL if num_sec is 0
+    uint64_t *sec_hash_arr;  // Hash of each section's contents
+    char *shstrtab;          // NULL if there is none
+    uint64_t shstrtab_size;
+    uint32_t num_seg;
+    elf64_phdr *prog_hdr_arr; // NULL if num_seg is 0
+} elf64_snapshot;
+
+// Slot of a section name index (hash table from name to section index)
+typedef struct {
+    uint64_t name_hash;
+    uint64_t sec_idx_plus_1; // 0 if the slot is empty
+} elf64_sec_name_slot;
+
 // Function declarations
+int process_elf64_files(char *file_path_arr[], int num_files,
+                        pelf_options *options);
+int process_elf64_file(const char *file_path, pelf_options *options);
+int open_elf64_file(const char *file_path, FILE **file_ptr);
+int print_elf64_file(const char *file_path);
+int checksec_elf64_file(const char *file_path);
+int watch_elf64_file(const char *file_path);
+int search_elf64_file(const char *file_path, const unsigned char *pattern,
+                      size_t pattern_size);
+unsigned char *parse_hex_pattern(const char *hex_str, size_t *pattern_size);
+void free_pelf_options(pelf_options *options);
+int check_elf64_versions(const char *file_path, elf64_version_policy *policy);
 elf64_hdr *parse_elf64_hdr(FILE *file);
 elf64_shdr *parse_elf64_shdrs(FILE *file, const elf64_hdr *file_hdr);
 elf64_phdr *parse_elf64_phdrs(FILE *file, const elf64_hdr *file_hdr);
+uint64_t get_num_sec(FILE *file, const elf64_hdr *file_hdr);
+uint32_t get_num_seg(FILE *file, const elf64_hdr *file_hdr);
+uint32_t get_shstrndx(FILE *file, const elf64_hdr *file_hdr);
 void print_dynamic_deps(FILE *file, const elf64_hdr *file_hdr,
                         const elf64_shdr *sec_hdr_arr);
+bool get_elf64_checksec(FILE *file, const elf64_hdr *file_hdr,
+                        elf64_checksec *checksec);
+void get_gnu_property_features(FILE *file, const elf64_phdr *prop_hdr,
+                               elf64_checksec *checksec);
+void print_elf64_checksec(const char *file_path,
+                          const elf64_checksec *checksec);
+elf64_snapshot *load_elf64_snapshot(const char *file_path);
+bool is_snapshot_current(const char *file_path,
+                         const elf64_snapshot *snapshot);
+void free_elf64_snapshot(elf64_snapshot *snapshot);
+void print_elf64_snapshot_delta(const elf64_snapshot *old_snapshot,
+                                const elf64_snapshot *new_snapshot);
+const char *get_snapshot_sec_name(const elf64_snapshot *snapshot,
+                                  uint64_t sec_idx);
+elf64_sec_name_slot *build_sec_name_index(const elf64_snapshot *snapshot,
+                                          uint64_t *index_cap);
+uint64_t get_str_hash(const char *str);
+uint64_t get_sec_data_hash(FILE *file, uint64_t file_offset,
+                           uint64_t sec_data_size);
+uint64_t update_data_hash(FILE *file, uint64_t file_offset, uint64_t data_size,
+                          uint64_t hash);
+const unsigned char *find_pattern(const unsigned char *data, size_t data_size,
+                                  const unsigned char *pattern,
+                                  size_t pattern_size);
+void print_sym_versions(FILE *file, const elf64_shdr *sec_hdr_arr,
+                        uint64_t num_sec);
+char *get_linked_strtab(FILE *file, const elf64_shdr *sec_hdr_arr,
+                        uint64_t num_sec, const elf64_shdr *sec_hdr,
+                        uint64_t *strtab_size);
+uint32_t *get_violation_syms(FILE *file, const elf64_shdr *sec_hdr_arr,
+                             uint64_t num_sec, uint64_t dynstr_size,
+                             elf64_version_violation *violation_arr,
+                             uint64_t num_violations);
+void print_version_violation(const char *file_path,
+                             const elf64_version_policy *policy,
+                             const elf64_version_violation *violation,
+                             const char *dynstr,
+                             const uint32_t *sym_name_arr);
+bool get_dynamic_ver_shdrs(FILE *file, const elf64_hdr *file_hdr,
+                           elf64_shdr *ver_shdr_arr, uint64_t *num_ver_sec);
+uint64_t get_dynamic_num_sym(FILE *file, const elf64_phdr *prog_hdr_arr,
+                             uint32_t num_seg, uint64_t hash_addr,
+                             uint64_t gnu_hash_addr);
+bool get_file_offset_using_addr(const elf64_phdr *prog_hdr_arr,
+                                uint32_t num_seg, uint64_t addr,
+                                uint64_t *file_offset, uint64_t *max_size);
+char *get_strtab_using_idx(FILE *file, const elf64_shdr *sec_hdr_arr,
+                           uint64_t num_sec, uint64_t strtab_idx,
+                           uint64_t *strtab_size);
+const elf64_shdr *get_sec_hdr_using_type(const elf64_shdr *sec_hdr_arr,
+                                         uint64_t num_sec, uint32_t sec_type);
+bool parse_version_name(const char *version_name, size_t *prefix_len,
+                        uint64_t *version_key);
+bool add_version_rule(elf64_version_policy *policy,
+                      const char *max_version_name);
+const elf64_version_entry *intern_version_name(elf64_version_policy *policy,
+                                               uint32_t hash,
+                                               const char *name);
+void free_version_policy(elf64_version_policy *policy);
 char *get_shstrtab(FILE *file, const elf64_hdr *file_hdr);
 const elf64_shdr *get_sec_hdr_using_name(FILE *file,
                                          const elf64_shdr *sec_hdr_arr,
@@ -96,11 +352,11 @@ char *get_sec_data_using_name(FILE *file, const elf64_shdr *sec_hdr_arr,
                               const elf64_hdr *file_hdr, char *sec_name);
 char *get_sec_data_using_offset(FILE *file, uint64_t file_offset,
                                 uint64_t sec_data_size);
-void print_elf64_hdr(const elf64_hdr *file_hdr);
-void print_elf64_shdrs(const elf64_shdr *sec_hdr_arr, uint16_t num_sec,
+void print_elf64_hdr(const elf64_hdr *file_hdr, uint64_t num_sec,
+                     uint32_t num_seg, uint32_t shstrndx);
+void print_elf64_shdrs(const elf64_shdr *sec_hdr_arr, uint64_t num_sec,
                        char *shstrtab);
-void print_elf64_phdrs(const elf64_phdr *prog_hdr_arr,
-                       const elf64_hdr *file_hdr);
+void print_elf64_phdrs(const elf64_phdr *prog_hdr_arr, uint32_t num_seg);
 void get_magic_bytes(FILE *file, unsigned char *magic_bytes);
 uint8_t get_elf_class(FILE *file);
 bool is_magic_bytes_elf(const unsigned char *magic_bytes);
@@ -1,22 +1,229 @@
 #include "pelf.h"
-#include <errno.h>  // For strerr()
-#include <stddef.h> // For 'NULL'
-#include <stdio.h>  // For file functions, printf()
-#include <stdlib.h> // For malloc(), free()
-#include <string.h> // For memcmp(), strcmp()
+#include <errno.h>       // For strerr()
+#include <libgen.h>      // For dirname(), basename()
+#include <stddef.h>      // For 'NULL'
+#include <stdint.h>      // For SIZE_MAX
+#include <stdio.h>       // For file functions, printf()
+#include <stdlib.h>      // For malloc(), free(), strtol()
+#include <string.h>      // For memcmp(), strcmp(), strdup()
+#include <sys/inotify.h> // For inotify_init1(), inotify_add_watch()
+#include <sys/mman.h>    // For mmap(), munmap()
+#include <sys/stat.h>    // For fstat()
+#include <sys/wait.h>    // For waitpid()
+#include <unistd.h>      // For read(), close(), fork()
 
 int main(int argc, char *argv[]) {
-    char *file_path = NULL;
+    pelf_options options = {0};
+    options.num_jobs = 1;
+    int num_modes = 0;
+    int arg_idx = 1;
+
+    // Get options from command line args
+    while (arg_idx < argc && strncmp(argv[arg_idx], "--", 2) == 0) {
+        const char *option = argv[arg_idx];
+        bool has_value = strcmp(option, "--search") == 0 ||
+                         strcmp(option, "--search-hex") == 0 ||
+                         strcmp(option, "--max-version") == 0 ||
+                         strcmp(option, "--jobs") == 0;
+
+        if (has_value &&
+            (arg_idx + 1 >= argc || argv[arg_idx + 1][0] == '\0')) {
+            printf("ERROR: '%s' needs a value.\n\n", option);
+            free_pelf_options(&options);
+            return 1;
+        }
+
+        if (strcmp(option, "--checksec") == 0) {
+            options.checksec_mode = true;
+            num_modes++;
+        } else if (strcmp(option, "--watch") == 0) {
+            options.watch_mode = true;
+            num_modes++;
+        } else if (strcmp(option, "--search") == 0 ||
+                   strcmp(option, "--search-hex") == 0) {
+            const char *pattern_arg = argv[++arg_idx];
+
+            free(options.search_pattern);
+            if (strcmp(option, "--search") == 0) {
+                options.search_pattern = (unsigned char *)strdup(pattern_arg);
+                options.search_pattern_size = strlen(pattern_arg);
+            } else {
+                options.search_pattern = parse_hex_pattern(
+                    pattern_arg, &(options.search_pattern_size));
+            }
+
+            if (options.search_pattern == NULL) {
+                printf("ERROR: Invalid search pattern '%s', expected hex "
+                       "bytes like '7f454c46'.\n\n",
+                       pattern_arg);
+                free_pelf_options(&options);
+                return 1;
+            }
+
+            num_modes++;
+        } else if (strcmp(option, "--max-version") == 0) {
+            if (options.version_policy.num_rules == 0) {
+                num_modes++;
+            }
+
+            if (!add_version_rule(&(options.version_policy), argv[++arg_idx])) {
+                printf("ERROR: Invalid version rule '%s', expected e.g. "
+                       "'GLIBC_2.28'.\n\n",
+                       argv[arg_idx]);
+                free_pelf_options(&options);
+                return 1;
+            }
+        } else if (strcmp(option, "--jobs") == 0) {
+            const char *jobs_arg = argv[++arg_idx];
+            char *jobs_end = NULL;
+
+            errno = 0;
+            long num_jobs = strtol(jobs_arg, &jobs_end, 10);
+
+            if (errno != 0 || *jobs_end != '\0' || num_jobs < 1 ||
+                num_jobs > MAX_JOBS) {
+                printf("ERROR: '--jobs' needs a number from 1 to %d, got "
+                       "'%s'.\n\n",
+                       MAX_JOBS, jobs_arg);
+                free_pelf_options(&options);
+                return 1;
+            }
+
+            options.num_jobs = num_jobs;
+        } else {
+            printf("ERROR: Unknown option '%s'.\n\n", option);
+            free_pelf_options(&options);
+            return 1;
+        }
+
+        arg_idx++;
+    }
 
-    // Get file path from command line args
-    if (argc < 2) {
+    // Get file paths from command line args
+    if (arg_idx >= argc) {
         printf("ERROR: Insufficient arguments. Please provide a path to a "
                "64-bit ELF file.\n\n");
+        free_pelf_options(&options);
+        return 1;
+    }
+
+    if (num_modes > 1) {
+        printf("ERROR: '--checksec', '--watch', '--search'/'--search-hex' "
+               "and '--max-version' can't be combined.\n\n");
+        free_pelf_options(&options);
+        return 1;
+    }
+
+    // Only the one-line-per-result modes can interleave the output of
+    // several workers
+    if (options.num_jobs > 1 && num_modes == 0) {
+        printf("ERROR: '--jobs' needs '--checksec', '--search' or "
+               "'--max-version'.\n\n");
         return 1;
+    }
+
+    if (options.watch_mode) {
+        if (arg_idx != argc - 1 || options.num_jobs > 1) {
+            printf("ERROR: '--watch' takes exactly one file.\n\n");
+            return 1;
+        }
+
+        return watch_elf64_file(argv[arg_idx]);
+    }
+
+    int ret_val =
+        process_elf64_files(&(argv[arg_idx]), argc - arg_idx, &options);
+
+    free_pelf_options(&options);
+
+    return ret_val;
+}
+
+// Process files one after the other, or spread them over 'num_jobs' worker
+// processes
+// Returns 0 if every file was processed successfully, or else the highest exit
+// code, so that a policy violation (4) is never hidden by a file that couldn't
+// be opened (2) or parsed (3), whatever the order the files finish in
+int process_elf64_files(char *file_path_arr[], int num_files,
+                        pelf_options *options) {
+    int num_jobs = (options->num_jobs < num_files) ? options->num_jobs
+                                                   : num_files;
+    int ret_val = 0;
+
+    if (num_jobs <= 1) {
+        for (int i = 0; i < num_files; i++) {
+            int file_ret_val = process_elf64_file(file_path_arr[i], options);
+
+            if (file_ret_val > ret_val) {
+                ret_val = file_ret_val;
+            }
+        }
+
+        return ret_val;
+    }
+
+    // Each worker takes every 'num_jobs'-th file. Workers flush after every
+    // line so that lines from different workers don't get mixed up.
+    fflush(stdout);
+    for (int job_idx = 0; job_idx < num_jobs; job_idx++) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            printf("ERROR: Could not start worker: %s\n\n", strerror(errno));
+            if (ret_val < 2) {
+                ret_val = 2;
+            }
+            break;
+        }
+
+        if (pid == 0) {
+            setvbuf(stdout, NULL, _IOLBF, 0);
+
+            for (int i = job_idx; i < num_files; i += num_jobs) {
+                int file_ret_val =
+                    process_elf64_file(file_path_arr[i], options);
+
+                if (file_ret_val > ret_val) {
+                    ret_val = file_ret_val;
+                }
+            }
+
+            fflush(stdout);
+            _exit(ret_val);
+        }
+    }
+
+    // A worker that didn't exit normally left some of its files unprocessed
+    int worker_status;
+    while (wait(&worker_status) > 0) {
+        int worker_ret_val =
+            WIFEXITED(worker_status) ? WEXITSTATUS(worker_status) : 3;
+
+        if (worker_ret_val > ret_val) {
+            ret_val = worker_ret_val;
+        }
+    }
+
+    return ret_val;
+}
+
+// Process a single file according to the selected mode
+int process_elf64_file(const char *file_path, pelf_options *options) {
+    if (options->search_pattern != NULL) {
+        return search_elf64_file(file_path, options->search_pattern,
+                                 options->search_pattern_size);
+    } else if (options->checksec_mode) {
+        return checksec_elf64_file(file_path);
+    } else if (options->version_policy.num_rules > 0) {
+        return check_elf64_versions(file_path, &(options->version_policy));
     } else {
-        file_path = argv[1];
+        return print_elf64_file(file_path);
     }
+}
 
+// Open a file and check that it is a 64-bit ELF
+// Returns 0 on success, or the exit code to report on failure
+int open_elf64_file(const char *file_path, FILE **file_ptr) {
     // Try to open file
     FILE *file = fopen(file_path, "rb");
     if (file == NULL) {
@@ -45,233 +252,2210 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    *file_ptr = file;
+    return 0;
+}
+
+// Print the headers and dynamic dependencies of a 64-bit ELF file
+int print_elf64_file(const char *file_path) {
+    FILE *file = NULL;
+    int open_ret_val = open_elf64_file(file_path, &file);
+
+    if (open_ret_val != 0) {
+        return open_ret_val;
+    }
+
     printf("64-bit ELF File Parser\n\n\n");
     printf("ELF details and value translations: "
            "https://en.wikipedia.org/wiki/Executable_and_Linkable_Format\n\n");
     printf("ELF file path: %s\n\n\n", file_path);
 
-    // Print ELF file header
-    elf64_hdr *file_hdr = parse_elf64_hdr(file);
+    // Print ELF file header
+    elf64_hdr *file_hdr = parse_elf64_hdr(file);
+
+    if (file_hdr == NULL) {
+        fclose(file);
+        printf("ERROR: File header could not be parsed.\n\n");
+        return 3;
+    }
+
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+    uint32_t num_seg = get_num_seg(file, file_hdr);
+
+    print_elf64_hdr(file_hdr, num_sec, num_seg, get_shstrndx(file, file_hdr));
+
+    // Print ELF section headers
+    elf64_shdr *sec_hdr_arr = NULL;
+    char *shstrtab = NULL;
+    if (num_sec > 0) {
+        sec_hdr_arr = parse_elf64_shdrs(file, file_hdr);
+
+        if (sec_hdr_arr == NULL) {
+            fclose(file);
+            free(file_hdr);
+            printf("ERROR: Section headers could not be parsed.\n\n");
+            return 3;
+        }
+
+        shstrtab = get_shstrtab(file, file_hdr);
+
+        if (shstrtab == NULL) {
+            fclose(file);
+            free(file_hdr);
+            free(sec_hdr_arr);
+            printf(
+                "ERROR: Section header string table could not be parsed.\n\n");
+            return 3;
+        }
+
+        print_elf64_shdrs(sec_hdr_arr, num_sec, shstrtab);
+    } else {
+        printf("NOTE: No section headers were found.\n\n");
+    }
+
+    // Print ELF segment (program) headers
+    elf64_phdr *prog_hdr_arr = NULL;
+    if (num_seg > 0) {
+        prog_hdr_arr = parse_elf64_phdrs(file, file_hdr);
+
+        if (prog_hdr_arr == NULL) {
+            fclose(file);
+            free(file_hdr);
+            free(sec_hdr_arr);
+            free(shstrtab);
+            printf("ERROR: Program (segment) headers could not be parsed.\n\n");
+            return 3;
+        }
+
+        print_elf64_phdrs(prog_hdr_arr, num_seg);
+    } else {
+        printf("NOTE: No program (segment) headers were found.\n\n");
+    }
+
+    // Print dynamic dependencies
+    print_dynamic_deps(file, file_hdr, sec_hdr_arr);
+
+    // Print symbol version definitions and requirements
+    print_sym_versions(file, sec_hdr_arr, num_sec);
+
+    // Cleanup
+    free(file_hdr);
+    free(sec_hdr_arr);
+    free(shstrtab);
+    free(prog_hdr_arr);
+    fclose(file);
+
+    return 0;
+}
+
+// Print the security hardening properties of a 64-bit ELF file
+int checksec_elf64_file(const char *file_path) {
+    FILE *file = NULL;
+    int open_ret_val = open_elf64_file(file_path, &file);
+
+    if (open_ret_val != 0) {
+        return open_ret_val;
+    }
+
+    elf64_hdr *file_hdr = parse_elf64_hdr(file);
+
+    if (file_hdr == NULL) {
+        fclose(file);
+        printf("ERROR: File header could not be parsed.\n\n");
+        return 3;
+    }
+
+    elf64_checksec checksec;
+    if (!get_elf64_checksec(file, file_hdr, &checksec)) {
+        fclose(file);
+        free(file_hdr);
+        printf("ERROR: Hardening properties of '%s' could not be parsed.\n\n",
+               file_path);
+        return 3;
+    }
+
+    print_elf64_checksec(file_path, &checksec);
+
+    // Cleanup
+    free(checksec.rpath);
+    free(checksec.runpath);
+    free(file_hdr);
+    fclose(file);
+
+    return 0;
+}
+
+// Check the symbol versions a file requires against the policy
+// Prints one line per broken rule, listing the symbols that need the version,
+// or a single OK line
+int check_elf64_versions(const char *file_path, elf64_version_policy *policy) {
+    FILE *file = NULL;
+    int open_ret_val = open_elf64_file(file_path, &file);
+
+    if (open_ret_val != 0) {
+        return open_ret_val;
+    }
+
+    elf64_hdr *file_hdr = parse_elf64_hdr(file);
+
+    if (file_hdr == NULL) {
+        fclose(file);
+        printf("ERROR: File header could not be parsed.\n\n");
+        return 3;
+    }
+
+    elf64_shdr *sec_hdr_arr = NULL;
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+    if (num_sec > 0) {
+        sec_hdr_arr = parse_elf64_shdrs(file, file_hdr);
+
+        if (sec_hdr_arr == NULL) {
+            fclose(file);
+            free(file_hdr);
+            printf("ERROR: Section headers of '%s' could not be parsed.\n\n",
+                   file_path);
+            return 3;
+        }
+    }
+
+    const elf64_shdr *ver_sec_hdr_arr = sec_hdr_arr;
+    uint64_t num_ver_sec = num_sec;
+    const elf64_shdr *verneed_shdr =
+        get_sec_hdr_using_type(sec_hdr_arr, num_sec, SHT_GNU_VERNEED);
+
+    // The section header table is optional (and can be stripped), so fall
+    // back to the dynamic segment the loader itself reads the requirements
+    // from
+    elf64_shdr dyn_ver_shdr_arr[NUM_DYN_VER_SEC];
+    if (verneed_shdr == NULL) {
+        if (!get_dynamic_ver_shdrs(file, file_hdr, dyn_ver_shdr_arr,
+                                   &num_ver_sec)) {
+            printf("ERROR: Dynamic segment of '%s' could not be parsed.\n\n",
+                   file_path);
+            free(file_hdr);
+            free(sec_hdr_arr);
+            fclose(file);
+            return 3;
+        }
+
+        ver_sec_hdr_arr = dyn_ver_shdr_arr;
+        verneed_shdr = get_sec_hdr_using_type(ver_sec_hdr_arr, num_ver_sec,
+                                              SHT_GNU_VERNEED);
+    }
+
+    // Nothing is required, e.g. statically linked
+    if (verneed_shdr == NULL) {
+        printf("%s: OK\n", file_path);
+        free(file_hdr);
+        free(sec_hdr_arr);
+        fclose(file);
+        return 0;
+    }
+
+    uint64_t dynstr_size = 0;
+    char *dynstr = get_linked_strtab(file, ver_sec_hdr_arr, num_ver_sec,
+                                     verneed_shdr, &dynstr_size);
+    uint64_t verneed_size = verneed_shdr->sh_size;
+    char *verneed_data = get_sec_data_using_offset(
+        file, verneed_shdr->sh_offset, verneed_size);
+    uint64_t violation_cap = 16;
+    elf64_version_violation *violation_arr =
+        malloc(violation_cap * sizeof(elf64_version_violation));
+
+    if (dynstr == NULL || verneed_data == NULL || violation_arr == NULL) {
+        printf("ERROR: Symbol versions of '%s' could not be parsed.\n\n",
+               file_path);
+        free(dynstr);
+        free(verneed_data);
+        free(violation_arr);
+        free(file_hdr);
+        free(sec_hdr_arr);
+        fclose(file);
+        return 3;
+    }
+
+    // Walk the requirements of each library
+    // The entries are linked by offsets taken from the file, so several
+    // libraries can share (or loop back into) the same names. Recording each
+    // version index only once bounds the violations at VERSYM_NUM_IDX.
+    uint64_t is_idx_violated[VERSYM_NUM_IDX / 64] = {0};
+    uint64_t num_violations = 0;
+    // sh_info (DT_VERNEEDNUM) is the number of libraries, if recorded
+    uint64_t vn_offset = 0;
+    for (uint64_t vn_idx = 0;
+         (verneed_shdr->sh_info == 0 || vn_idx < verneed_shdr->sh_info) &&
+         vn_offset + sizeof(elf64_verneed) <= verneed_size;
+         vn_idx++) {
+        elf64_verneed verneed;
+        memcpy(&verneed, verneed_data + vn_offset, sizeof(elf64_verneed));
+
+        const char *lib_name =
+            (verneed.vn_file < dynstr_size) ? dynstr + verneed.vn_file : "";
+        uint64_t vna_offset = vn_offset + verneed.vn_aux;
+
+        for (uint16_t i = 0; i < verneed.vn_cnt &&
+                             vna_offset + sizeof(elf64_vernaux) <= verneed_size;
+             i++) {
+            elf64_vernaux vernaux;
+            memcpy(&vernaux, verneed_data + vna_offset, sizeof(elf64_vernaux));
+
+            if (vernaux.vna_name < dynstr_size) {
+                const char *version_name = dynstr + vernaux.vna_name;
+                const elf64_version_entry *entry =
+                    intern_version_name(policy, vernaux.vna_hash, version_name);
+
+                uint16_t ver_idx = vernaux.vna_other & ~VERSYM_HIDDEN;
+                uint64_t idx_bit = 1UL << (ver_idx % 64);
+
+                if (entry != NULL && entry->rule_idx >= 0 &&
+                    entry->version_key >
+                        policy->rule_arr[entry->rule_idx].max_version_key &&
+                    !(is_idx_violated[ver_idx / 64] & idx_bit)) {
+                    if (num_violations == violation_cap) {
+                        elf64_version_violation *new_violation_arr = realloc(
+                            violation_arr, violation_cap * 2 *
+                                               sizeof(elf64_version_violation));
+
+                        if (new_violation_arr == NULL) {
+                            break;
+                        }
+
+                        violation_arr = new_violation_arr;
+                        violation_cap *= 2;
+                    }
+
+                    elf64_version_violation *violation =
+                        &(violation_arr[num_violations]);
+
+                    violation->ver_idx = ver_idx;
+                    violation->rule_idx = entry->rule_idx;
+                    violation->version_name = version_name;
+                    violation->lib_name = lib_name;
+                    is_idx_violated[ver_idx / 64] |= idx_bit;
+                    num_violations++;
+                }
+            }
+
+            if (vernaux.vna_next == 0) {
+                break;
+            }
+            vna_offset += vernaux.vna_next;
+        }
+
+        if (verneed.vn_next == 0) {
+            break;
+        }
+        vn_offset += verneed.vn_next;
+    }
+
+    uint32_t *sym_name_arr = NULL;
+    if (num_violations > 0) {
+        sym_name_arr = get_violation_syms(file, ver_sec_hdr_arr, num_ver_sec,
+                                          dynstr_size, violation_arr,
+                                          num_violations);
+    } else {
+        printf("%s: OK\n", file_path);
+    }
+
+    for (uint64_t i = 0; i < num_violations; i++) {
+        print_version_violation(file_path, policy, &(violation_arr[i]), dynstr,
+                                sym_name_arr);
+    }
+
+    // Cleanup
+    free(sym_name_arr);
+    free(violation_arr);
+    free(verneed_data);
+    free(dynstr);
+    free(file_hdr);
+    free(sec_hdr_arr);
+    fclose(file);
+
+    return (num_violations > 0) ? 4 : 0;
+}
+
+// Collect the undefined dynamic symbols that need each broken version
+// '.gnu.version' and '.dynsym' are read once, and the symbols' name offsets are
+// bucketed by violation, in symbol order, into the returned array (see
+// 'first_sym' and 'num_syms')
+// Returns NULL if the symbols couldn't be read, leaving every bucket empty
+uint32_t *get_violation_syms(FILE *file, const elf64_shdr *sec_hdr_arr,
+                             uint64_t num_sec, uint64_t dynstr_size,
+                             elf64_version_violation *violation_arr,
+                             uint64_t num_violations) {
+    for (uint64_t i = 0; i < num_violations; i++) {
+        violation_arr[i].first_sym = 0;
+        violation_arr[i].num_syms = 0;
+    }
+
+    const elf64_shdr *dynsym_shdr =
+        get_sec_hdr_using_type(sec_hdr_arr, num_sec, SHT_DYNSYM);
+    const elf64_shdr *versym_shdr =
+        get_sec_hdr_using_type(sec_hdr_arr, num_sec, SHT_GNU_VERSYM);
+
+    if (dynsym_shdr == NULL || versym_shdr == NULL ||
+        dynsym_shdr->sh_entsize != sizeof(elf64_sym)) {
+        return NULL;
+    }
+
+    // '.gnu.version' has one entry per '.dynsym' entry
+    uint64_t num_sym = dynsym_shdr->sh_size / sizeof(elf64_sym);
+    if (versym_shdr->sh_size / sizeof(uint16_t) < num_sym) {
+        num_sym = versym_shdr->sh_size / sizeof(uint16_t);
+    }
+
+    if (num_sym == 0) {
+        return NULL;
+    }
+
+    uint16_t *versym_arr = (uint16_t *)get_sec_data_using_offset(
+        file, versym_shdr->sh_offset, num_sym * sizeof(uint16_t));
+    elf64_sym *sym_arr = (elf64_sym *)get_sec_data_using_offset(
+        file, dynsym_shdr->sh_offset, num_sym * sizeof(elf64_sym));
+
+    // Version index -> position in 'violation_arr' + 1 (0 if not broken)
+    uint32_t *violation_lookup = calloc(VERSYM_NUM_IDX, sizeof(uint32_t));
+    uint32_t *sym_name_arr = NULL;
+
+    if (versym_arr != NULL && sym_arr != NULL && violation_lookup != NULL) {
+        for (uint64_t i = 0; i < num_violations; i++) {
+            violation_lookup[violation_arr[i].ver_idx] = i + 1;
+        }
+
+        // Count the symbols of each violation, then place them
+        uint64_t num_violation_syms = 0;
+        for (uint64_t i = 0; i < num_sym; i++) {
+            uint32_t violation_pos =
+                violation_lookup[versym_arr[i] & ~VERSYM_HIDDEN];
+
+            if (violation_pos != 0 && sym_arr[i].st_shndx == SHN_UNDEF &&
+                sym_arr[i].st_name < dynstr_size) {
+                violation_arr[violation_pos - 1].num_syms++;
+                num_violation_syms++;
+            }
+        }
+
+        sym_name_arr = malloc((num_violation_syms + 1) * sizeof(uint32_t));
+    }
+
+    if (sym_name_arr != NULL) {
+        uint64_t next_sym = 0;
+        for (uint64_t i = 0; i < num_violations; i++) {
+            violation_arr[i].first_sym = next_sym;
+            next_sym += violation_arr[i].num_syms;
+            violation_arr[i].num_syms = 0;
+        }
+
+        for (uint64_t i = 0; i < num_sym; i++) {
+            uint32_t violation_pos =
+                violation_lookup[versym_arr[i] & ~VERSYM_HIDDEN];
+
+            if (violation_pos != 0 && sym_arr[i].st_shndx == SHN_UNDEF &&
+                sym_arr[i].st_name < dynstr_size) {
+                elf64_version_violation *violation =
+                    &(violation_arr[violation_pos - 1]);
+
+                sym_name_arr[violation->first_sym + violation->num_syms] =
+                    sym_arr[i].st_name;
+                violation->num_syms++;
+            }
+        }
+    } else {
+        for (uint64_t i = 0; i < num_violations; i++) {
+            violation_arr[i].num_syms = 0;
+        }
+    }
+
+    // Cleanup
+    free(violation_lookup);
+    free(sym_arr);
+    free(versym_arr);
+
+    return sym_name_arr;
+}
+
+// Print a broken version rule and the undefined dynamic symbols that need the
+// offending version
+void print_version_violation(const char *file_path,
+                             const elf64_version_policy *policy,
+                             const elf64_version_violation *violation,
+                             const char *dynstr,
+                             const uint32_t *sym_name_arr) {
+    printf("%s: FAIL %s > %s (%s):", file_path, violation->version_name,
+           policy->rule_arr[violation->rule_idx].max_version_name,
+           violation->lib_name);
+
+    for (uint64_t i = 0; i < violation->num_syms; i++) {
+        printf("%s%s", (i == 0) ? " " : ", ",
+               dynstr + sym_name_arr[violation->first_sym + i]);
+    }
+    printf("\n");
+}
+
+// Build stand-in section headers for '.dynstr', '.gnu.version_r',
+// '.gnu.version' and '.dynsym' (in that order) from the dynamic segment's
+// DT_STRTAB, DT_VERNEED, DT_VERSYM and DT_SYMTAB entries
+// Sets 'num_ver_sec' to 0 if the file requires no versions. '.gnu.version'
+// and '.dynsym' are only needed to list the symbols, so they are left as
+// SHT_NULL if they can't be sized.
+// Returns false if the dynamic segment or the tables it points to can't be
+// located in the file
+bool get_dynamic_ver_shdrs(FILE *file, const elf64_hdr *file_hdr,
+                           elf64_shdr *ver_shdr_arr, uint64_t *num_ver_sec) {
+    *num_ver_sec = 0;
+    memset(ver_shdr_arr, 0, NUM_DYN_VER_SEC * sizeof(elf64_shdr));
+
+    elf64_phdr *prog_hdr_arr = NULL;
+    const elf64_phdr *dyn_phdr = NULL;
+    uint32_t num_seg = get_num_seg(file, file_hdr);
+    if (num_seg > 0) {
+        prog_hdr_arr = parse_elf64_phdrs(file, file_hdr);
+
+        if (prog_hdr_arr == NULL) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < num_seg; i++) {
+        if (prog_hdr_arr[i].p_type == PT_DYNAMIC) {
+            dyn_phdr = &(prog_hdr_arr[i]);
+        }
+    }
+
+    // Statically linked: nothing is required
+    if (dyn_phdr == NULL) {
+        free(prog_hdr_arr);
+        return true;
+    }
+
+    uint64_t strtab_addr = 0;
+    uint64_t strtab_size = 0;
+    uint64_t symtab_addr = 0;
+    uint64_t sym_ent_size = sizeof(elf64_sym);
+    uint64_t hash_addr = 0;
+    uint64_t gnu_hash_addr = 0;
+    uint64_t versym_addr = 0;
+    uint64_t verneed_addr = 0;
+    uint64_t verneed_num = 0;
+
+    fseek(file, dyn_phdr->p_offset, SEEK_SET);
+    for (uint64_t i = 0; i < dyn_phdr->p_filesz / sizeof(elf64_dyn); i++) {
+        elf64_dyn dyn_ent;
+
+        if (fread(&dyn_ent, sizeof(elf64_dyn), 1, file) != 1 ||
+            dyn_ent.d_tag == DT_NULL) {
+            break;
+        }
+
+        switch (dyn_ent.d_tag) {
+        case DT_STRTAB:
+            strtab_addr = dyn_ent.d_ptr;
+            break;
+        case DT_STRSZ:
+            strtab_size = dyn_ent.d_val;
+            break;
+        case DT_SYMTAB:
+            symtab_addr = dyn_ent.d_ptr;
+            break;
+        case DT_SYMENT:
+            sym_ent_size = dyn_ent.d_val;
+            break;
+        case DT_HASH:
+            hash_addr = dyn_ent.d_ptr;
+            break;
+        case DT_GNU_HASH:
+            gnu_hash_addr = dyn_ent.d_ptr;
+            break;
+        case DT_VERSYM:
+            versym_addr = dyn_ent.d_ptr;
+            break;
+        case DT_VERNEED:
+            verneed_addr = dyn_ent.d_ptr;
+            break;
+        case DT_VERNEEDNUM:
+            verneed_num = dyn_ent.d_val;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // No version requirements
+    if (verneed_addr == 0) {
+        free(prog_hdr_arr);
+        return true;
+    }
+
+    // '.dynstr' and '.gnu.version_r' are needed for the check itself. The
+    // size of '.gnu.version_r' isn't recorded, but it can't run past the end
+    // of its segment.
+    uint64_t strtab_offset;
+    uint64_t strtab_max_size;
+    uint64_t verneed_offset;
+    uint64_t verneed_max_size;
+    if (strtab_addr == 0 || strtab_size == 0 ||
+        !get_file_offset_using_addr(prog_hdr_arr, num_seg, strtab_addr,
+                                    &strtab_offset, &strtab_max_size) ||
+        strtab_size > strtab_max_size ||
+        !get_file_offset_using_addr(prog_hdr_arr, num_seg, verneed_addr,
+                                    &verneed_offset, &verneed_max_size)) {
+        free(prog_hdr_arr);
+        return false;
+    }
+
+    elf64_shdr *dynstr_shdr = &(ver_shdr_arr[0]);
+    dynstr_shdr->sh_type = SHT_STRTAB;
+    dynstr_shdr->sh_offset = strtab_offset;
+    dynstr_shdr->sh_size = strtab_size;
+
+    elf64_shdr *verneed_shdr = &(ver_shdr_arr[1]);
+    verneed_shdr->sh_type = SHT_GNU_VERNEED;
+    verneed_shdr->sh_offset = verneed_offset;
+    verneed_shdr->sh_size = verneed_max_size;
+    verneed_shdr->sh_link = 0;
+    verneed_shdr->sh_info = verneed_num;
+
+    // '.gnu.version' and '.dynsym' have one entry per dynamic symbol
+    uint64_t num_sym = get_dynamic_num_sym(file, prog_hdr_arr, num_seg,
+                                           hash_addr, gnu_hash_addr);
+    uint64_t versym_offset;
+    uint64_t versym_max_size;
+    uint64_t symtab_offset;
+    uint64_t symtab_max_size;
+    if (num_sym > 0 && sym_ent_size == sizeof(elf64_sym) && versym_addr != 0 &&
+        symtab_addr != 0 &&
+        get_file_offset_using_addr(prog_hdr_arr, num_seg, versym_addr,
+                                   &versym_offset, &versym_max_size) &&
+        get_file_offset_using_addr(prog_hdr_arr, num_seg, symtab_addr,
+                                   &symtab_offset, &symtab_max_size) &&
+        num_sym <= versym_max_size / sizeof(uint16_t) &&
+        num_sym <= symtab_max_size / sizeof(elf64_sym)) {
+        elf64_shdr *versym_shdr = &(ver_shdr_arr[2]);
+        versym_shdr->sh_type = SHT_GNU_VERSYM;
+        versym_shdr->sh_offset = versym_offset;
+        versym_shdr->sh_size = num_sym * sizeof(uint16_t);
+        versym_shdr->sh_link = 3;
+
+        elf64_shdr *dynsym_shdr = &(ver_shdr_arr[3]);
+        dynsym_shdr->sh_type = SHT_DYNSYM;
+        dynsym_shdr->sh_offset = symtab_offset;
+        dynsym_shdr->sh_size = num_sym * sizeof(elf64_sym);
+        dynsym_shdr->sh_entsize = sizeof(elf64_sym);
+        dynsym_shdr->sh_link = 0;
+    }
+
+    free(prog_hdr_arr);
+
+    *num_ver_sec = NUM_DYN_VER_SEC;
+    return true;
+}
+
+// Get the number of dynamic symbols from the dynamic segment's hash table
+// DT_HASH records it outright (as the number of chains). DT_GNU_HASH doesn't,
+// so the chain of the highest bucket is walked to its end instead.
+// Returns 0 if neither table can be read
+uint64_t get_dynamic_num_sym(FILE *file, const elf64_phdr *prog_hdr_arr,
+                             uint32_t num_seg, uint64_t hash_addr,
+                             uint64_t gnu_hash_addr) {
+    uint64_t file_offset;
+    uint64_t max_size;
+
+    if (hash_addr != 0 &&
+        get_file_offset_using_addr(prog_hdr_arr, num_seg, hash_addr,
+                                   &file_offset, &max_size) &&
+        max_size >= 2 * sizeof(uint32_t)) {
+        uint32_t hash_hdr[2]; // nbucket, nchain
+
+        fseek(file, file_offset, SEEK_SET);
+        if (fread(hash_hdr, sizeof(uint32_t), 2, file) == 2) {
+            return hash_hdr[1];
+        }
+    }
+
+    if (gnu_hash_addr == 0 ||
+        !get_file_offset_using_addr(prog_hdr_arr, num_seg, gnu_hash_addr,
+                                    &file_offset, &max_size) ||
+        max_size < 4 * sizeof(uint32_t)) {
+        return 0;
+    }
+
+    uint32_t gnu_hash_hdr[4]; // nbuckets, symoffset, bloom_size, bloom_shift
+
+    fseek(file, file_offset, SEEK_SET);
+    if (fread(gnu_hash_hdr, sizeof(uint32_t), 4, file) != 4) {
+        return 0;
+    }
+
+    // The buckets follow the bloom filter, and the chains (one entry per
+    // hashed symbol, starting at 'symoffset') follow the buckets
+    uint64_t num_buckets = gnu_hash_hdr[0];
+    uint64_t sym_offset = gnu_hash_hdr[1];
+    uint64_t buckets_offset =
+        (4 * sizeof(uint32_t)) + ((uint64_t)gnu_hash_hdr[2] * sizeof(uint64_t));
+
+    if (num_buckets == 0 || buckets_offset > max_size ||
+        num_buckets > (max_size - buckets_offset) / sizeof(uint32_t)) {
+        return 0;
+    }
+
+    uint32_t *bucket_arr = (uint32_t *)get_sec_data_using_offset(
+        file, file_offset + buckets_offset, num_buckets * sizeof(uint32_t));
+
+    if (bucket_arr == NULL) {
+        return 0;
+    }
+
+    uint64_t max_bucket = 0;
+    for (uint64_t i = 0; i < num_buckets; i++) {
+        if (bucket_arr[i] > max_bucket) {
+            max_bucket = bucket_arr[i];
+        }
+    }
+
+    free(bucket_arr);
+
+    // Every bucket is empty: only the unhashed symbols before 'symoffset'
+    if (max_bucket < sym_offset) {
+        return sym_offset;
+    }
+
+    // The last entry of a chain has its lowest bit set
+    uint64_t chains_offset =
+        buckets_offset + (num_buckets * sizeof(uint32_t));
+    uint64_t sym_idx = max_bucket;
+    uint32_t chain_val;
+
+    fseek(file,
+          file_offset + chains_offset +
+              ((sym_idx - sym_offset) * sizeof(uint32_t)),
+          SEEK_SET);
+    while (chains_offset + ((sym_idx - sym_offset + 1) * sizeof(uint32_t)) <=
+               max_size &&
+           fread(&chain_val, sizeof(uint32_t), 1, file) == 1) {
+        if (chain_val & 1) {
+            return sym_idx + 1;
+        }
+
+        sym_idx++;
+    }
+
+    return 0;
+}
+
+// Map a virtual address to a file offset through the PT_LOAD segments
+// 'max_size' is set to how much of the segment's file contents start there
+bool get_file_offset_using_addr(const elf64_phdr *prog_hdr_arr,
+                                uint32_t num_seg, uint64_t addr,
+                                uint64_t *file_offset, uint64_t *max_size) {
+    for (uint32_t i = 0; i < num_seg; i++) {
+        const elf64_phdr *prog_hdr = &(prog_hdr_arr[i]);
+
+        if (prog_hdr->p_type == PT_LOAD && addr >= prog_hdr->p_vaddr &&
+            addr - prog_hdr->p_vaddr < prog_hdr->p_filesz) {
+            *file_offset = prog_hdr->p_offset + (addr - prog_hdr->p_vaddr);
+            *max_size = prog_hdr->p_filesz - (addr - prog_hdr->p_vaddr);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Get the first MAGIC_BYTE_COUNT bytes of the file
+// If the file is an ELF, this will be the magic number
+void get_magic_bytes(FILE *file, unsigned char *magic_bytes) {
+    fseek(file, 0L, SEEK_SET);
+    fread(magic_bytes, sizeof(unsigned char), MAGIC_BYTE_COUNT, file);
+}
+
+// Check if file's magic bytes match an ELF's magic bytes
+bool is_magic_bytes_elf(const unsigned char *magic_bytes) {
+    return memcmp(magic_bytes, ELF_MAGIC_BYTES, MAGIC_BYTE_COUNT) == 0;
+}
+
+// Get the class of an ELF: 1 (32-bit) or 2 (64-bit)
+uint8_t get_elf_class(FILE *file) {
+    uint8_t elf_class;
+    fseek(file, MAGIC_BYTE_COUNT, SEEK_SET);
+    fread(&elf_class, sizeof(elf_class), 1, file);
+    return elf_class;
+}
+
+// Parse the 64-bit ELF file header
+// Returns NULL if the file is too short to hold one
+elf64_hdr *parse_elf64_hdr(FILE *file) {
+    elf64_hdr *file_hdr = (elf64_hdr *)malloc(sizeof(elf64_hdr));
+
+    if (file_hdr == NULL) {
+        return NULL;
+    }
+
+    fseek(file, 0L, SEEK_SET);
+    if (fread(file_hdr, sizeof(elf64_hdr), 1, file) != 1) {
+        free(file_hdr);
+        return NULL;
+    }
+
+    return file_hdr;
+}
+
+// Get the number of section headers
+// If there are SHN_LORESERVE (0xff00) or more sections, e_shnum is 0 and the
+// actual count is stored in the first section header's sh_size member as per
+// the standard
+uint64_t get_num_sec(FILE *file, const elf64_hdr *file_hdr) {
+    if (file_hdr->e_shnum != 0 || file_hdr->e_shoff == 0) {
+        return file_hdr->e_shnum;
+    }
+
+    elf64_shdr first_sec_hdr;
+
+    fseek(file, file_hdr->e_shoff, SEEK_SET);
+    if (fread(&first_sec_hdr, sizeof(elf64_shdr), 1, file) != 1) {
+        return 0;
+    }
+
+    return first_sec_hdr.sh_size;
+}
+
+// Get the number of segment (program) headers
+// If there are PN_XNUM (0xffff) or more segments, e_phnum is PN_XNUM and the
+// actual count is stored in the first section header's sh_info member as per
+// the standard
+uint32_t get_num_seg(FILE *file, const elf64_hdr *file_hdr) {
+    if (file_hdr->e_phnum != PN_XNUM || file_hdr->e_shoff == 0) {
+        return file_hdr->e_phnum;
+    }
+
+    elf64_shdr first_sec_hdr;
+
+    fseek(file, file_hdr->e_shoff, SEEK_SET);
+    if (fread(&first_sec_hdr, sizeof(elf64_shdr), 1, file) != 1) {
+        return 0;
+    }
+
+    return first_sec_hdr.sh_info;
+}
+
+// Get the index of the section header string table's section header
+// If the index is SHN_LORESERVE (0xff00) or more, e_shstrndx is SHN_XINDEX and
+// the actual index is stored in the first section header's sh_link member as
+// per the standard
+uint32_t get_shstrndx(FILE *file, const elf64_hdr *file_hdr) {
+    if (file_hdr->e_shstrndx != SHN_XINDEX || file_hdr->e_shoff == 0) {
+        return file_hdr->e_shstrndx;
+    }
+
+    elf64_shdr first_sec_hdr;
+
+    fseek(file, file_hdr->e_shoff, SEEK_SET);
+    if (fread(&first_sec_hdr, sizeof(elf64_shdr), 1, file) != 1) {
+        return SHN_UNDEF;
+    }
+
+    return first_sec_hdr.sh_link;
+}
+
+// Parse all the 64-bit ELF section headers
+elf64_shdr *parse_elf64_shdrs(FILE *file, const elf64_hdr *file_hdr) {
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+
+    // An extended section count is read from the file, so check that the
+    // table fits in the file before allocating for it
+    struct stat file_stat;
+    if (num_sec == 0 || fstat(fileno(file), &file_stat) != 0 ||
+        file_hdr->e_shoff > (uint64_t)file_stat.st_size ||
+        num_sec > ((uint64_t)file_stat.st_size - file_hdr->e_shoff) /
+                      sizeof(elf64_shdr)) {
+        return NULL;
+    }
+
+    elf64_shdr *sec_hdr_arr = malloc(num_sec * sizeof(elf64_shdr));
+
+    if (sec_hdr_arr == NULL) {
+        return NULL;
+    }
+
+    fseek(file, file_hdr->e_shoff, SEEK_SET);
+    if (fread(sec_hdr_arr, sizeof(elf64_shdr), num_sec, file) != num_sec) {
+        free(sec_hdr_arr);
+        return NULL;
+    }
+
+    return sec_hdr_arr;
+}
+
+// Parse all the 64-bit ELF segment (program) headers
+elf64_phdr *parse_elf64_phdrs(FILE *file, const elf64_hdr *file_hdr) {
+    uint32_t num_seg = get_num_seg(file, file_hdr);
+
+    // Same for an extended segment count
+    struct stat file_stat;
+    if (num_seg == 0 || fstat(fileno(file), &file_stat) != 0 ||
+        file_hdr->e_phoff > (uint64_t)file_stat.st_size ||
+        num_seg > ((uint64_t)file_stat.st_size - file_hdr->e_phoff) /
+                      sizeof(elf64_phdr)) {
+        return NULL;
+    }
+
+    elf64_phdr *prog_hdr_arr = malloc((size_t)num_seg * sizeof(elf64_phdr));
+
+    if (prog_hdr_arr == NULL) {
+        return NULL;
+    }
+
+    fseek(file, file_hdr->e_phoff, SEEK_SET);
+    if (fread(prog_hdr_arr, sizeof(elf64_phdr), num_seg, file) != num_seg) {
+        free(prog_hdr_arr);
+        return NULL;
+    }
+
+    return prog_hdr_arr;
+}
+
+// Print the names and locations of dynamically loaded
+// libraries/dependencies
+void print_dynamic_deps(FILE *file, const elf64_hdr *file_hdr,
+                        const elf64_shdr *sec_hdr_arr) {
+    // Get the '.dynamic' section header
+    const elf64_shdr *dyn_shdr =
+        get_sec_hdr_using_name(file, sec_hdr_arr, file_hdr, ".dynamic");
+
+    if (dyn_shdr == NULL) {
+        printf("NOTE: No dynamic section was found.\n\n");
+        return;
+    }
+
+    // Get the 'elf64_dyn' entries in the '.dynamic' section
+    uint64_t dyn_sec_offset = dyn_shdr->sh_offset;
+    uint64_t dyn_sec_size = dyn_shdr->sh_size;
+    uint64_t dyn_ent_size = dyn_shdr->sh_entsize;
+    uint64_t dyn_ent_num = dyn_sec_size / dyn_ent_size;
+
+    elf64_dyn *dyn_ent_arr = malloc(dyn_ent_num * sizeof(elf64_dyn));
+
+    if (dyn_ent_arr == NULL) {
+        free((void *)dyn_shdr);
+        printf("NOTE: No memory could be allocated for dynamic section "
+               "entries.\n\n");
+        return;
+    }
+
+    fseek(file, dyn_sec_offset, SEEK_SET);
+    fread(dyn_ent_arr, sizeof(elf64_dyn), dyn_ent_num, file);
+
+    // Get the contents of the '.dynstr' section
+    char *dynstr_sec_data =
+        get_sec_data_using_name(file, sec_hdr_arr, file_hdr, ".dynstr");
+
+    if (dynstr_sec_data == NULL) {
+        free((void *)dyn_shdr);
+        free(dyn_ent_arr);
+        printf("NOTE: No dynamic section was found.\n\n");
+        return;
+    }
+
+    // Print the library names
+    printf("Dynamic dependencies listed in the ELF file:\n");
+    for (uint64_t i = 0; i < dyn_ent_num; i++) {
+        elf64_dyn dyn_ent = dyn_ent_arr[i];
+
+        if (dyn_ent.d_tag == DT_NEEDED) {
+            uint64_t str_tab_offset = dyn_ent.d_val;
+
+            printf("-> %s\n", (dynstr_sec_data + str_tab_offset));
+        }
+    }
+    printf("\n");
+    printf("NOTE: Each dependency might have its own dependencies.\n");
+    printf("\n\n");
+
+    // Print the library search paths, if any
+    bool has_search_path = false;
+    for (uint64_t i = 0; i < dyn_ent_num; i++) {
+        elf64_dyn dyn_ent = dyn_ent_arr[i];
+
+        if (dyn_ent.d_tag == DT_RPATH || dyn_ent.d_tag == DT_RUNPATH) {
+            if (!has_search_path) {
+                printf("Library search paths listed in the ELF file:\n");
+                has_search_path = true;
+            }
+
+            printf("-> %s: %s\n",
+                   (dyn_ent.d_tag == DT_RPATH) ? "RPATH" : "RUNPATH",
+                   (dynstr_sec_data + dyn_ent.d_val));
+        }
+    }
+    if (has_search_path) {
+        printf("\n\n");
+    }
+
+    // Cleanup
+    free(dyn_ent_arr);
+    free(dynstr_sec_data);
+}
+
+// Print every occurrence of a pattern in the loaded sections of a file
+// The file is mapped instead of read so that only the scanned sections are
+// paged in
+int search_elf64_file(const char *file_path, const unsigned char *pattern,
+                      size_t pattern_size) {
+    FILE *file = NULL;
+    int open_ret_val = open_elf64_file(file_path, &file);
+
+    if (open_ret_val != 0) {
+        return open_ret_val;
+    }
+
+    elf64_hdr *file_hdr = parse_elf64_hdr(file);
+
+    if (file_hdr == NULL) {
+        fclose(file);
+        printf("ERROR: File header could not be parsed.\n\n");
+        return 3;
+    }
+
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+
+    if (num_sec == 0) {
+        free(file_hdr);
+        fclose(file);
+        return 0;
+    }
+
+    // Section names are only printed, so a malformed string table just
+    // leaves them empty
+    elf64_shdr *sec_hdr_arr = parse_elf64_shdrs(file, file_hdr);
+    char *shstrtab = NULL;
+    uint64_t shstrtab_size = 0;
+    if (sec_hdr_arr != NULL) {
+        shstrtab = get_strtab_using_idx(file, sec_hdr_arr, num_sec,
+                                        get_shstrndx(file, file_hdr),
+                                        &shstrtab_size);
+    }
+    struct stat file_stat;
+    unsigned char *file_data = MAP_FAILED;
+
+    if (sec_hdr_arr != NULL && fstat(fileno(file), &file_stat) == 0 &&
+        file_stat.st_size > 0) {
+        file_data = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE,
+                         fileno(file), 0);
+    }
+
+    if (file_data == MAP_FAILED) {
+        printf("ERROR: Sections of '%s' could not be read.\n\n", file_path);
+        free(file_hdr);
+        free(sec_hdr_arr);
+        free(shstrtab);
+        fclose(file);
+        return 3;
+    }
+
+    madvise(file_data, file_stat.st_size, MADV_SEQUENTIAL);
+
+    uint64_t file_size = file_stat.st_size;
+
+    for (uint64_t i = 0; i < num_sec; i++) {
+        const elf64_shdr *sec_hdr = &(sec_hdr_arr[i]);
+
+        // Only sections that are loaded and have contents in the file
+        if (!(sec_hdr->sh_flags & SHF_ALLOC) ||
+            sec_hdr->sh_type == SHT_NOBITS ||
+            sec_hdr->sh_offset > file_size ||
+            sec_hdr->sh_size > file_size - sec_hdr->sh_offset) {
+            continue;
+        }
+
+        const char *sec_name = (sec_hdr->sh_name < shstrtab_size)
+                                   ? shstrtab + sec_hdr->sh_name
+                                   : "";
+        const unsigned char *sec_data = file_data + sec_hdr->sh_offset;
+        const unsigned char *sec_data_end = sec_data + sec_hdr->sh_size;
+        const unsigned char *match = sec_data;
+
+        while ((match = find_pattern(match, sec_data_end - match,
+                                     pattern, pattern_size)) != NULL) {
+            uint64_t match_offset = match - sec_data;
+
+            printf("%s: %s offset %#lx address %#lx\n", file_path, sec_name,
+                   sec_hdr->sh_offset + match_offset,
+                   sec_hdr->sh_addr + match_offset);
+
+            match++;
+        }
+    }
+
+    // Cleanup
+    munmap(file_data, file_stat.st_size);
+    free(file_hdr);
+    free(sec_hdr_arr);
+    free(shstrtab);
+    fclose(file);
+
+    return 0;
+}
+
+// Parse a search pattern given as hex bytes, e.g. "7f454c46"
+// Returns NULL if the string is empty, has an odd length or isn't hex
+unsigned char *parse_hex_pattern(const char *hex_str, size_t *pattern_size) {
+    size_t hex_len = strlen(hex_str);
+
+    if (hex_len == 0 || hex_len % 2 != 0) {
+        return NULL;
+    }
+
+    unsigned char *pattern = malloc(hex_len / 2);
+
+    if (pattern == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < hex_len; i += 2) {
+        unsigned int byte_val;
+        char byte_str[3] = {hex_str[i], hex_str[i + 1], '\0'};
+
+        if (strspn(byte_str, "0123456789abcdefABCDEF") != 2 ||
+            sscanf(byte_str, "%2x", &byte_val) != 1) {
+            free(pattern);
+            return NULL;
+        }
+
+        pattern[i / 2] = byte_val;
+    }
+
+    *pattern_size = hex_len / 2;
+    return pattern;
+}
+
+// Find the first occurrence of a pattern in a block of data
+// memchr() skips to candidates for the pattern's first byte with the C
+// library's vectorised (SSE2/AVX2) scan, and memcmp() verifies each of them
+const unsigned char *find_pattern(const unsigned char *data, size_t data_size,
+                                  const unsigned char *pattern,
+                                  size_t pattern_size) {
+    if (pattern_size == 0 || pattern_size > data_size) {
+        return NULL;
+    }
+
+    const unsigned char *last_start = data + (data_size - pattern_size);
+    const unsigned char *candidate = data;
+
+    while (candidate <= last_start) {
+        candidate = memchr(candidate, pattern[0], (last_start - candidate) + 1);
+
+        if (candidate == NULL) {
+            return NULL;
+        }
+
+        if (memcmp(candidate + 1, pattern + 1, pattern_size - 1) == 0) {
+            return candidate;
+        }
+
+        candidate++;
+    }
+
+    return NULL;
+}
+
+// Print the file once, then print what changed in its headers and sections
+// every time it is rewritten, until interrupted
+int watch_elf64_file(const char *file_path) {
+    int print_ret_val = print_elf64_file(file_path);
+
+    if (print_ret_val != 0) {
+        return print_ret_val;
+    }
+
+    elf64_snapshot *snapshot = load_elf64_snapshot(file_path);
+
+    if (snapshot == NULL) {
+        printf("ERROR: Headers of '%s' could not be cached.\n\n", file_path);
+        return 3;
+    }
+
+    // Linkers usually replace the output file instead of rewriting it in
+    // place, so watch the parent directory for the file's name
+    char *dir_path_buf = strdup(file_path);
+    char *file_name_buf = strdup(file_path);
+    int inotify_fd = inotify_init1(0);
+
+    if (dir_path_buf == NULL || file_name_buf == NULL || inotify_fd < 0 ||
+        inotify_add_watch(inotify_fd, dirname(dir_path_buf),
+                          IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        printf("ERROR: Could not watch '%s': %s\n\n", file_path,
+               strerror(errno));
+        free(dir_path_buf);
+        free(file_name_buf);
+        free_elf64_snapshot(snapshot);
+        if (inotify_fd >= 0) {
+            close(inotify_fd);
+        }
+        return 2;
+    }
+
+    const char *file_name = basename(file_name_buf);
+
+    printf("Watching '%s' for changes...\n\n", file_path);
+    fflush(stdout);
+
+    char event_buf[4096]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t event_buf_len;
+    while ((event_buf_len = read(inotify_fd, event_buf, sizeof(event_buf))) >
+           0) {
+        bool is_file_changed = false;
+
+        for (char *event_ptr = event_buf; event_ptr < event_buf + event_buf_len;
+             event_ptr += sizeof(struct inotify_event) +
+                          ((struct inotify_event *)event_ptr)->len) {
+            const struct inotify_event *event =
+                (const struct inotify_event *)event_ptr;
+
+            if (event->len > 0 && strcmp(event->name, file_name) == 0) {
+                is_file_changed = true;
+            }
+        }
+
+        if (!is_file_changed) {
+            continue;
+        }
+
+        // Same inode, size and modification time (e.g. closed without
+        // writing): nothing to read
+        if (is_snapshot_current(file_path, snapshot)) {
+            printf("Changes:\nNOTE: No changes.\n\n");
+            fflush(stdout);
+            continue;
+        }
+
+        elf64_snapshot *new_snapshot = load_elf64_snapshot(file_path);
+
+        if (new_snapshot == NULL) {
+            printf("NOTE: '%s' could not be parsed, waiting for the next "
+                   "change.\n\n",
+                   file_path);
+            fflush(stdout);
+            continue;
+        }
+
+        print_elf64_snapshot_delta(snapshot, new_snapshot);
+        fflush(stdout);
+
+        free_elf64_snapshot(snapshot);
+        snapshot = new_snapshot;
+    }
+
+    // Cleanup
+    free(dir_path_buf);
+    free(file_name_buf);
+    free_elf64_snapshot(snapshot);
+    close(inotify_fd);
+
+    return 0;
+}
+
+// Read the header tables of a 64-bit ELF file and hash every section's
+// contents, so that later versions of the file can be compared against them
+elf64_snapshot *load_elf64_snapshot(const char *file_path) {
+    FILE *file = NULL;
+
+    if (open_elf64_file(file_path, &file) != 0) {
+        return NULL;
+    }
+
+    elf64_snapshot *snapshot =
+        (elf64_snapshot *)calloc(1, sizeof(elf64_snapshot));
+    elf64_hdr *file_hdr = parse_elf64_hdr(file);
+
+    if (snapshot == NULL || file_hdr == NULL) {
+        free(snapshot);
+        free(file_hdr);
+        fclose(file);
+        return NULL;
+    }
+
+    snapshot->file_hdr = *file_hdr;
+    free(file_hdr);
+
+    struct stat file_stat;
+    if (fstat(fileno(file), &file_stat) == 0) {
+        snapshot->file_dev = file_stat.st_dev;
+        snapshot->file_ino = file_stat.st_ino;
+        snapshot->file_size = file_stat.st_size;
+        snapshot->file_mtime_ns = (file_stat.st_mtim.tv_sec * 1000000000UL) +
+                                  file_stat.st_mtim.tv_nsec;
+    }
+
+    snapshot->num_sec = get_num_sec(file, &(snapshot->file_hdr));
+    if (snapshot->num_sec > 0) {
+        snapshot->sec_hdr_arr = parse_elf64_shdrs(file, &(snapshot->file_hdr));
+        snapshot->sec_hash_arr = malloc(snapshot->num_sec * sizeof(uint64_t));
+
+        if (snapshot->sec_hdr_arr == NULL || snapshot->sec_hash_arr == NULL) {
+            free_elf64_snapshot(snapshot);
+            fclose(file);
+            return NULL;
+        }
+
+        // Names are looked up for every section when comparing, so a file
+        // with a malformed string table or an out-of-range name isn't cached
+        uint32_t shstrndx = get_shstrndx(file, &(snapshot->file_hdr));
+        if (shstrndx != SHN_UNDEF) {
+            snapshot->shstrtab = get_strtab_using_idx(
+                file, snapshot->sec_hdr_arr, snapshot->num_sec, shstrndx,
+                &(snapshot->shstrtab_size));
+
+            if (snapshot->shstrtab == NULL) {
+                free_elf64_snapshot(snapshot);
+                fclose(file);
+                return NULL;
+            }
+        }
+
+        for (uint64_t i = 0; i < snapshot->num_sec; i++) {
+            const elf64_shdr *sec_hdr = &(snapshot->sec_hdr_arr[i]);
+
+            if (snapshot->shstrtab != NULL &&
+                sec_hdr->sh_name >= snapshot->shstrtab_size) {
+                free_elf64_snapshot(snapshot);
+                fclose(file);
+                return NULL;
+            }
+
+            if (sec_hdr->sh_type == SHT_NOBITS) {
+                snapshot->sec_hash_arr[i] = 0;
+            } else {
+                snapshot->sec_hash_arr[i] = get_sec_data_hash(
+                    file, sec_hdr->sh_offset, sec_hdr->sh_size);
+            }
+        }
+    }
+
+    snapshot->num_seg = get_num_seg(file, &(snapshot->file_hdr));
+    if (snapshot->num_seg > 0) {
+        snapshot->prog_hdr_arr = parse_elf64_phdrs(file, &(snapshot->file_hdr));
+
+        if (snapshot->prog_hdr_arr == NULL) {
+            free_elf64_snapshot(snapshot);
+            fclose(file);
+            return NULL;
+        }
+    }
+
+    fclose(file);
+
+    return snapshot;
+}
+
+// Check whether a file is still the one a snapshot was taken of, going by its
+// inode, size and modification time only
+bool is_snapshot_current(const char *file_path,
+                         const elf64_snapshot *snapshot) {
+    struct stat file_stat;
+
+    if (stat(file_path, &file_stat) != 0) {
+        return false;
+    }
+
+    uint64_t file_mtime_ns =
+        (file_stat.st_mtim.tv_sec * 1000000000UL) + file_stat.st_mtim.tv_nsec;
+
+    return (uint64_t)file_stat.st_dev == snapshot->file_dev &&
+           (uint64_t)file_stat.st_ino == snapshot->file_ino &&
+           (uint64_t)file_stat.st_size == snapshot->file_size &&
+           file_mtime_ns == snapshot->file_mtime_ns;
+}
+
+// Free a snapshot and everything it owns
+void free_elf64_snapshot(elf64_snapshot *snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+
+    free(snapshot->sec_hdr_arr);
+    free(snapshot->sec_hash_arr);
+    free(snapshot->shstrtab);
+    free(snapshot->prog_hdr_arr);
+    free(snapshot);
+}
+
+// Print what changed between two snapshots of the same file
+// Sections are matched by name, so inserting or removing a section shows up
+// as just that and not as a change to every section after it
+void print_elf64_snapshot_delta(const elf64_snapshot *old_snapshot,
+                                const elf64_snapshot *new_snapshot) {
+    const elf64_hdr *old_hdr = &(old_snapshot->file_hdr);
+    const elf64_hdr *new_hdr = &(new_snapshot->file_hdr);
+    uint64_t num_changes = 0;
+
+    printf("Changes:\n");
+
+    // File header
+    if (old_hdr->e_type != new_hdr->e_type) {
+        printf("~ File header: type %#04x -> %#04x\n", old_hdr->e_type,
+               new_hdr->e_type);
+        num_changes++;
+    }
+    if (old_hdr->e_entry != new_hdr->e_entry) {
+        printf("~ File header: entry address %#lx -> %#lx\n",
+               old_hdr->e_entry, new_hdr->e_entry);
+        num_changes++;
+    }
+    if (old_hdr->e_flags != new_hdr->e_flags) {
+        printf("~ File header: flags %#x -> %#x\n", old_hdr->e_flags,
+               new_hdr->e_flags);
+        num_changes++;
+    }
+
+    // Section headers and contents
+    bool *is_old_sec_matched = calloc(old_snapshot->num_sec + 1, sizeof(bool));
+    uint64_t name_index_cap = 0;
+    elf64_sec_name_slot *name_index =
+        build_sec_name_index(old_snapshot, &name_index_cap);
+
+    if (is_old_sec_matched == NULL || name_index == NULL) {
+        free(is_old_sec_matched);
+        free(name_index);
+        printf("NOTE: No memory could be allocated to compare sections.\n\n");
+        return;
+    }
+
+    int64_t idx_shift = 0;
+    for (uint64_t i = 0; i < new_snapshot->num_sec; i++) {
+        const elf64_shdr *new_sec_hdr = &(new_snapshot->sec_hdr_arr[i]);
+        const char *sec_name = get_snapshot_sec_name(new_snapshot, i);
+
+        // Try the position the previous match suggests before looking the
+        // name up, which keeps runs of same-named sections in order
+        uint64_t old_idx = i + idx_shift;
+        bool is_found =
+            old_idx < old_snapshot->num_sec && !is_old_sec_matched[old_idx] &&
+            strcmp(sec_name, get_snapshot_sec_name(old_snapshot, old_idx)) == 0;
+
+        uint64_t name_hash = get_str_hash(sec_name);
+        for (uint64_t slot = name_hash & (name_index_cap - 1);
+             !is_found && name_index[slot].sec_idx_plus_1 != 0;
+             slot = (slot + 1) & (name_index_cap - 1)) {
+            old_idx = name_index[slot].sec_idx_plus_1 - 1;
+
+            is_found = name_index[slot].name_hash == name_hash &&
+                       !is_old_sec_matched[old_idx] &&
+                       strcmp(sec_name, get_snapshot_sec_name(
+                                            old_snapshot, old_idx)) == 0;
+        }
+
+        if (!is_found) {
+            printf("+ [%lu] %s: offset %lu, size %lu\n", i, sec_name,
+                   new_sec_hdr->sh_offset, new_sec_hdr->sh_size);
+            num_changes++;
+            continue;
+        }
+
+        is_old_sec_matched[old_idx] = true;
+        idx_shift = (int64_t)old_idx - (int64_t)i;
+
+        const elf64_shdr *old_sec_hdr = &(old_snapshot->sec_hdr_arr[old_idx]);
+        bool is_offset_changed =
+            old_sec_hdr->sh_offset != new_sec_hdr->sh_offset;
+        bool is_addr_changed = old_sec_hdr->sh_addr != new_sec_hdr->sh_addr;
+        bool is_size_changed = old_sec_hdr->sh_size != new_sec_hdr->sh_size;
+        bool is_data_changed = old_snapshot->sec_hash_arr[old_idx] !=
+                               new_snapshot->sec_hash_arr[i];
+
+        if (!is_offset_changed && !is_addr_changed && !is_size_changed &&
+            !is_data_changed) {
+            continue;
+        }
+
+        const char *field_sep = " ";
+        printf("~ [%lu] %s:", i, sec_name);
+        if (is_offset_changed) {
+            printf("%soffset %lu -> %lu", field_sep, old_sec_hdr->sh_offset,
+                   new_sec_hdr->sh_offset);
+            field_sep = ", ";
+        }
+        if (is_addr_changed) {
+            printf("%saddress %#lx -> %#lx", field_sep, old_sec_hdr->sh_addr,
+                   new_sec_hdr->sh_addr);
+            field_sep = ", ";
+        }
+        if (is_size_changed) {
+            printf("%ssize %lu -> %lu", field_sep, old_sec_hdr->sh_size,
+                   new_sec_hdr->sh_size);
+            field_sep = ", ";
+        }
+        if (is_data_changed) {
+            printf("%scontents changed", field_sep);
+        }
+        printf("\n");
+        num_changes++;
+    }
+
+    for (uint64_t i = 0; i < old_snapshot->num_sec; i++) {
+        if (!is_old_sec_matched[i]) {
+            printf("- [%lu] %s\n", i, get_snapshot_sec_name(old_snapshot, i));
+            num_changes++;
+        }
+    }
+
+    free(is_old_sec_matched);
+    free(name_index);
+
+    // Segment (program) headers, matched by position
+    for (uint32_t i = 0;
+         i < old_snapshot->num_seg || i < new_snapshot->num_seg; i++) {
+        if (i >= old_snapshot->num_seg) {
+            printf("+ Segment [%u]\n", i);
+            num_changes++;
+            continue;
+        }
+        if (i >= new_snapshot->num_seg) {
+            printf("- Segment [%u]\n", i);
+            num_changes++;
+            continue;
+        }
+
+        const elf64_phdr *old_prog_hdr = &(old_snapshot->prog_hdr_arr[i]);
+        const elf64_phdr *new_prog_hdr = &(new_snapshot->prog_hdr_arr[i]);
+
+        if (memcmp(old_prog_hdr, new_prog_hdr, sizeof(elf64_phdr)) != 0) {
+            char *seg_type_name = get_seg_type_name(new_prog_hdr->p_type);
+
+            printf("~ Segment [%u] %s: offset %#lx -> %#lx, address %#lx -> "
+                   "%#lx, size %#lx -> %#lx\n",
+                   i, (seg_type_name != NULL) ? seg_type_name : "",
+                   old_prog_hdr->p_offset, new_prog_hdr->p_offset,
+                   old_prog_hdr->p_vaddr, new_prog_hdr->p_vaddr,
+                   old_prog_hdr->p_memsz, new_prog_hdr->p_memsz);
+            num_changes++;
+        }
+    }
+
+    if (num_changes == 0) {
+        printf("NOTE: No changes.\n");
+    }
+    printf("\n");
+}
+
+// Get the name of a section in a snapshot
+const char *get_snapshot_sec_name(const elf64_snapshot *snapshot,
+                                  uint64_t sec_idx) {
+    uint32_t sec_name_offset = snapshot->sec_hdr_arr[sec_idx].sh_name;
+
+    if (snapshot->shstrtab == NULL ||
+        sec_name_offset >= snapshot->shstrtab_size) {
+        return "";
+    }
+
+    return snapshot->shstrtab + sec_name_offset;
+}
+
+// Build a hash table from section name to section index for a snapshot, so
+// that sections can be matched across snapshots without rescanning
+// Same-named sections all get a slot, in section order
+elf64_sec_name_slot *build_sec_name_index(const elf64_snapshot *snapshot,
+                                          uint64_t *index_cap) {
+    // Keep the table at most half full
+    uint64_t cap = 16;
+    while (cap < snapshot->num_sec * 2) {
+        cap *= 2;
+    }
+
+    elf64_sec_name_slot *name_index = calloc(cap, sizeof(elf64_sec_name_slot));
+
+    if (name_index == NULL) {
+        return NULL;
+    }
+
+    for (uint64_t i = 0; i < snapshot->num_sec; i++) {
+        uint64_t name_hash = get_str_hash(get_snapshot_sec_name(snapshot, i));
+        uint64_t slot = name_hash & (cap - 1);
+
+        while (name_index[slot].sec_idx_plus_1 != 0) {
+            slot = (slot + 1) & (cap - 1);
+        }
+
+        name_index[slot].name_hash = name_hash;
+        name_index[slot].sec_idx_plus_1 = i + 1;
+    }
+
+    *index_cap = cap;
+    return name_index;
+}
+
+// Hash a string with 64-bit FNV-1a
+uint64_t get_str_hash(const char *str) {
+    uint64_t hash = 0xcbf29ce484222325UL;
+
+    for (; *str != '\0'; str++) {
+        hash = (hash ^ (unsigned char)*str) * 0x100000001b3UL;
+    }
+
+    return hash;
+}
+
+// Hash the contents of a section so that rebuilds can be detected without
+// keeping the old contents around
+// Every byte is hashed: a same-size edit in the middle of '.text' (e.g. a
+// changed constant) is the most common rebuild, and unchanged files aren't
+// read at all (see is_snapshot_current())
+uint64_t get_sec_data_hash(FILE *file, uint64_t file_offset,
+                           uint64_t sec_data_size) {
+    uint64_t hash = update_data_hash(file, file_offset, sec_data_size,
+                                     0xcbf29ce484222325UL);
+
+    return hash ^ sec_data_size;
+}
+
+// Add a range of the file to a hash without keeping it in memory
+// This is 64-bit FNV-1a applied to 8-byte words, which is plenty to detect
+// rebuilds and runs much faster than the byte-wise version
+uint64_t update_data_hash(FILE *file, uint64_t file_offset, uint64_t data_size,
+                          uint64_t hash) {
+    uint64_t word_buf[8192];
+    uint64_t remaining_size = data_size;
+
+    fseek(file, file_offset, SEEK_SET);
+    while (remaining_size > 0) {
+        size_t chunk_size = (remaining_size < sizeof(word_buf))
+                                ? remaining_size
+                                : sizeof(word_buf);
+        size_t read_size = fread(word_buf, 1, chunk_size, file);
+
+        if (read_size == 0) {
+            break;
+        }
+
+        // Zero-pad the last partial word
+        size_t num_words = (read_size + 7) / 8;
+        memset((unsigned char *)word_buf + read_size, 0,
+               num_words * 8 - read_size);
+
+        for (size_t i = 0; i < num_words; i++) {
+            hash = (hash ^ word_buf[i]) * 0x100000001b3UL;
+        }
+
+        remaining_size -= read_size;
+    }
+
+    return hash;
+}
+
+// Get the security hardening properties of a 64-bit ELF file
+// Only the header tables, the dynamic segment, '.dynsym' and '.dynstr' are
+// read, each of them once. Sections are located by type instead of by name so
+// that the section header string table isn't needed.
+bool get_elf64_checksec(FILE *file, const elf64_hdr *file_hdr,
+                        elf64_checksec *checksec) {
+    memset(checksec, 0, sizeof(elf64_checksec));
+    checksec->e_type = file_hdr->e_type;
+
+    // Program headers: interpreter, dynamic segment, stack, RELRO and CET
+    elf64_phdr *prog_hdr_arr = NULL;
+    const elf64_phdr *dyn_phdr = NULL;
+    uint32_t num_seg = get_num_seg(file, file_hdr);
+    if (num_seg > 0) {
+        prog_hdr_arr = parse_elf64_phdrs(file, file_hdr);
+
+        if (prog_hdr_arr == NULL) {
+            return false;
+        }
+    }
 
-    if (file_hdr == NULL) {
-        fclose(file);
-        printf("ERROR: File header could not be parsed.\n\n");
-        return 3;
+    for (uint32_t i = 0; i < num_seg; i++) {
+        const elf64_phdr *prog_hdr = &(prog_hdr_arr[i]);
+
+        switch (prog_hdr->p_type) {
+        case PT_INTERP:
+            checksec->has_interp = true;
+            break;
+        case PT_DYNAMIC:
+            dyn_phdr = prog_hdr;
+            break;
+        case PT_GNU_STACK:
+            checksec->has_gnu_stack = true;
+            checksec->has_exec_stack = (prog_hdr->p_flags & PF_X) != 0;
+            break;
+        case PT_GNU_RELRO:
+            checksec->has_relro = true;
+            break;
+        case PT_GNU_PROPERTY:
+            get_gnu_property_features(file, prog_hdr, checksec);
+            break;
+        default:
+            break;
+        }
     }
 
-    print_elf64_hdr(file_hdr);
+    // Statically linked: nothing else to look at
+    if (dyn_phdr == NULL) {
+        free(prog_hdr_arr);
+        return true;
+    }
 
-    // Print ELF section headers
+    // Section headers: '.dynsym' and the '.dynstr' it links to
     elf64_shdr *sec_hdr_arr = NULL;
-    char *shstrtab = NULL;
-    if (file_hdr->e_shnum > 0) {
+    const elf64_shdr *dynsym_shdr = NULL;
+    const elf64_shdr *dynstr_shdr = NULL;
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+    if (num_sec > 0) {
         sec_hdr_arr = parse_elf64_shdrs(file, file_hdr);
 
         if (sec_hdr_arr == NULL) {
-            fclose(file);
-            free(file_hdr);
-            printf("ERROR: Section headers could not be parsed.\n\n");
-            return 3;
+            free(prog_hdr_arr);
+            return false;
         }
+    }
 
-        shstrtab = get_shstrtab(file, file_hdr);
+    for (uint64_t i = 0; i < num_sec; i++) {
+        const elf64_shdr *sec_hdr = &(sec_hdr_arr[i]);
 
-        if (shstrtab == NULL) {
-            fclose(file);
-            free(file_hdr);
-            free(sec_hdr_arr);
-            printf(
-                "ERROR: Section header string table could not be parsed.\n\n");
-            return 3;
+        if (sec_hdr->sh_link >= num_sec) {
+            continue;
         }
 
-        print_elf64_shdrs(sec_hdr_arr, file_hdr->e_shnum, shstrtab);
-    } else {
-        printf("NOTE: No section headers were found.\n\n");
+        if (sec_hdr->sh_type == SHT_DYNSYM) {
+            dynsym_shdr = sec_hdr;
+            dynstr_shdr = &(sec_hdr_arr[sec_hdr->sh_link]);
+        } else if (sec_hdr->sh_type == SHT_DYNAMIC && dynstr_shdr == NULL) {
+            dynstr_shdr = &(sec_hdr_arr[sec_hdr->sh_link]);
+        }
     }
 
-    // Print ELF segment (program) headers
-    elf64_phdr *prog_hdr_arr = NULL;
-    if (file_hdr->e_phnum > 0) {
-        prog_hdr_arr = parse_elf64_phdrs(file, file_hdr);
+    char *dynstr = NULL;
+    uint64_t dynstr_size = 0;
+    if (dynstr_shdr != NULL && dynstr_shdr->sh_size > 0) {
+        dynstr_size = dynstr_shdr->sh_size;
+        dynstr = get_sec_data_using_offset(file, dynstr_shdr->sh_offset,
+                                           dynstr_size);
+
+        // Every string offset is checked against the size, so a terminated
+        // last string is enough to keep all lookups inside the buffer
+        if (dynstr != NULL && dynstr[dynstr_size - 1] != '\0') {
+            free(dynstr);
+            dynstr = NULL;
+        }
+    }
 
-        if (shstrtab == NULL) {
-            fclose(file);
-            free(file_hdr);
-            free(sec_hdr_arr);
-            free(shstrtab);
-            printf("ERROR: Program (segment) headers could not be parsed.\n\n");
-            return 3;
+    // Dynamic segment: BIND_NOW, PIE flag and library search paths
+    fseek(file, dyn_phdr->p_offset, SEEK_SET);
+    for (uint64_t i = 0; i < dyn_phdr->p_filesz / sizeof(elf64_dyn); i++) {
+        elf64_dyn dyn_ent;
+
+        if (fread(&dyn_ent, sizeof(elf64_dyn), 1, file) != 1 ||
+            dyn_ent.d_tag == DT_NULL) {
+            break;
         }
 
-        print_elf64_phdrs(prog_hdr_arr, file_hdr);
-    } else {
-        printf("NOTE: No program (segment) headers were found.\n\n");
+        switch (dyn_ent.d_tag) {
+        case DT_BIND_NOW:
+            checksec->has_bind_now = true;
+            break;
+        case DT_FLAGS:
+            if (dyn_ent.d_val & DF_BIND_NOW) {
+                checksec->has_bind_now = true;
+            }
+            break;
+        case DT_FLAGS_1:
+            if (dyn_ent.d_val & DF_1_NOW) {
+                checksec->has_bind_now = true;
+            }
+            if (dyn_ent.d_val & DF_1_PIE) {
+                checksec->has_pie_flag = true;
+            }
+            break;
+        case DT_RPATH:
+            if (dynstr != NULL && dyn_ent.d_val < dynstr_size &&
+                checksec->rpath == NULL) {
+                checksec->rpath = strdup(dynstr + dyn_ent.d_val);
+            }
+            break;
+        case DT_RUNPATH:
+            if (dynstr != NULL && dyn_ent.d_val < dynstr_size &&
+                checksec->runpath == NULL) {
+                checksec->runpath = strdup(dynstr + dyn_ent.d_val);
+            }
+            break;
+        default:
+            break;
+        }
     }
 
-    // Print dynamic dependencies
-    print_dynamic_deps(file, file_hdr, sec_hdr_arr);
+    // '.dynsym': stack protector and FORTIFY_SOURCE imports
+    if (dynsym_shdr != NULL && dynstr != NULL &&
+        dynsym_shdr->sh_entsize == sizeof(elf64_sym)) {
+        uint64_t num_sym = dynsym_shdr->sh_size / sizeof(elf64_sym);
+
+        fseek(file, dynsym_shdr->sh_offset, SEEK_SET);
+        for (uint64_t i = 0; i < num_sym; i++) {
+            elf64_sym sym;
+
+            if (fread(&sym, sizeof(elf64_sym), 1, file) != 1) {
+                break;
+            }
+
+            // Only imports count: a library that defines these symbols
+            // (like libc) isn't itself protected by them
+            if (sym.st_shndx != SHN_UNDEF || sym.st_name == 0 ||
+                sym.st_name >= dynstr_size) {
+                continue;
+            }
+
+            const char *sym_name = dynstr + sym.st_name;
+            size_t sym_name_len = strlen(sym_name);
+
+            if (strcmp(sym_name, "__stack_chk_fail") == 0 ||
+                strcmp(sym_name, "__stack_chk_guard") == 0) {
+                checksec->has_canary = true;
+            } else if (sym_name_len > 6 && strncmp(sym_name, "__", 2) == 0 &&
+                       strcmp(sym_name + sym_name_len - 4, "_chk") == 0) {
+                checksec->num_fortified++;
+            }
+        }
+    }
 
     // Cleanup
-    free(file_hdr);
+    free(dynstr);
     free(sec_hdr_arr);
-    free(shstrtab);
     free(prog_hdr_arr);
-    fclose(file);
 
-    return 0;
+    return true;
 }
 
-// Get the first MAGIC_BYTE_COUNT bytes of the file
-// If the file is an ELF, this will be the magic number
-void get_magic_bytes(FILE *file, unsigned char *magic_bytes) {
-    fseek(file, 0L, SEEK_SET);
-    fread(magic_bytes, sizeof(unsigned char), MAGIC_BYTE_COUNT, file);
-}
+// Get the x86 CET features (IBT, SHSTK) from a PT_GNU_PROPERTY segment
+void get_gnu_property_features(FILE *file, const elf64_phdr *prop_hdr,
+                               elf64_checksec *checksec) {
+    // The segment holds a single small note, so anything bigger is bogus
+    if (prop_hdr->p_filesz < sizeof(elf64_nhdr) || prop_hdr->p_filesz > 4096) {
+        return;
+    }
 
-// Check if file's magic bytes match an ELF's magic bytes
-bool is_magic_bytes_elf(const unsigned char *magic_bytes) {
-    return memcmp(magic_bytes, ELF_MAGIC_BYTES, MAGIC_BYTE_COUNT) == 0;
+    unsigned char *prop_data = (unsigned char *)get_sec_data_using_offset(
+        file, prop_hdr->p_offset, prop_hdr->p_filesz);
+
+    if (prop_data == NULL) {
+        return;
+    }
+
+    // Notes in PT_GNU_PROPERTY are 8-byte aligned on 64-bit ELFs
+    uint64_t note_offset = 0;
+    while (note_offset + sizeof(elf64_nhdr) <= prop_hdr->p_filesz) {
+        elf64_nhdr nhdr;
+        memcpy(&nhdr, prop_data + note_offset, sizeof(elf64_nhdr));
+
+        uint64_t name_offset = note_offset + sizeof(elf64_nhdr);
+        uint64_t desc_offset = (name_offset + nhdr.n_namesz + 7) & ~7UL;
+        uint64_t desc_end = desc_offset + nhdr.n_descsz;
+
+        if (desc_end > prop_hdr->p_filesz) {
+            break;
+        }
+
+        if (nhdr.n_type == NT_GNU_PROPERTY_TYPE_0 && nhdr.n_namesz == 4 &&
+            memcmp(prop_data + name_offset, "GNU", 4) == 0) {
+            // Each property is a type, a data size and the data
+            uint64_t pr_offset = desc_offset;
+            while (pr_offset + 8 <= desc_end) {
+                uint32_t pr_type;
+                uint32_t pr_datasz;
+                memcpy(&pr_type, prop_data + pr_offset, 4);
+                memcpy(&pr_datasz, prop_data + pr_offset + 4, 4);
+
+                if (pr_offset + 8 + pr_datasz > desc_end) {
+                    break;
+                }
+
+                if (pr_type == GNU_PROPERTY_X86_FEATURE_1_AND &&
+                    pr_datasz >= 4) {
+                    uint32_t features;
+                    memcpy(&features, prop_data + pr_offset + 8, 4);
+
+                    checksec->has_ibt =
+                        (features & GNU_PROPERTY_X86_FEATURE_1_IBT) != 0;
+                    checksec->has_shstk =
+                        (features & GNU_PROPERTY_X86_FEATURE_1_SHSTK) != 0;
+                }
+
+                pr_offset += 8 + ((pr_datasz + 7) & ~7UL);
+            }
+        }
+
+        note_offset = (desc_end + 7) & ~7UL;
+    }
+
+    free(prop_data);
 }
 
-// Get the class of an ELF: 1 (32-bit) or 2 (64-bit)
-uint8_t get_elf_class(FILE *file) {
-    uint8_t elf_class;
-    fseek(file, MAGIC_BYTE_COUNT, SEEK_SET);
-    fread(&elf_class, sizeof(elf_class), 1, file);
-    return elf_class;
+// Print the security hardening properties of a 64-bit ELF file on one line
+void print_elf64_checksec(const char *file_path,
+                          const elf64_checksec *checksec) {
+    char *relro = "No";
+    if (checksec->has_relro) {
+        relro = checksec->has_bind_now ? "Full" : "Partial";
+    }
+
+    char *pie = "N/A";
+    if (checksec->e_type == ET_EXEC) {
+        pie = "No";
+    } else if (checksec->e_type == ET_DYN) {
+        pie = (checksec->has_pie_flag || checksec->has_interp) ? "Yes" : "DSO";
+    }
+
+    // Without PT_GNU_STACK, the stack defaults to executable
+    bool has_nx = checksec->has_gnu_stack && !checksec->has_exec_stack;
+
+    printf("%s: RELRO=%s BIND_NOW=%s PIE=%s NX=%s Canary=%s FORTIFY=%s(%lu) "
+           "IBT=%s SHSTK=%s RPATH=%s RUNPATH=%s\n",
+           file_path, relro, checksec->has_bind_now ? "Yes" : "No", pie,
+           has_nx ? "Yes" : "No", checksec->has_canary ? "Yes" : "No",
+           (checksec->num_fortified > 0) ? "Yes" : "No",
+           checksec->num_fortified, checksec->has_ibt ? "Yes" : "No",
+           checksec->has_shstk ? "Yes" : "No",
+           (checksec->rpath != NULL) ? checksec->rpath : "None",
+           (checksec->runpath != NULL) ? checksec->runpath : "None");
 }
 
-// Parse the 64-bit ELF file header
-elf64_hdr *parse_elf64_hdr(FILE *file) {
-    elf64_hdr *file_hdr = (elf64_hdr *)malloc(sizeof(elf64_hdr));
+// Print the symbol version definitions ('.gnu.version_d') and requirements
+// ('.gnu.version_r')
+void print_sym_versions(FILE *file, const elf64_shdr *sec_hdr_arr,
+                        uint64_t num_sec) {
+    const elf64_shdr *verdef_shdr =
+        get_sec_hdr_using_type(sec_hdr_arr, num_sec, SHT_GNU_VERDEF);
+    const elf64_shdr *verneed_shdr =
+        get_sec_hdr_using_type(sec_hdr_arr, num_sec, SHT_GNU_VERNEED);
+
+    if (verdef_shdr == NULL && verneed_shdr == NULL) {
+        printf("NOTE: No symbol versions were found.\n\n");
+        return;
+    }
 
-    fseek(file, 0L, SEEK_SET);
-    fread(file_hdr, sizeof(elf64_hdr), 1, file);
+    // Both sections link to '.dynstr'
+    uint64_t dynstr_size = 0;
+    char *dynstr = get_linked_strtab(
+        file, sec_hdr_arr, num_sec,
+        (verdef_shdr != NULL) ? verdef_shdr : verneed_shdr, &dynstr_size);
 
-    return file_hdr;
+    if (dynstr == NULL) {
+        printf("NOTE: No symbol version names were found.\n\n");
+        return;
+    }
+
+    if (verdef_shdr != NULL) {
+        uint64_t verdef_size = verdef_shdr->sh_size;
+        char *verdef_data = get_sec_data_using_offset(
+            file, verdef_shdr->sh_offset, verdef_size);
+
+        printf("Symbol version definitions listed in the ELF file:\n");
+
+        uint64_t vd_offset = 0;
+        while (verdef_data != NULL &&
+               vd_offset + sizeof(elf64_verdef) <= verdef_size) {
+            elf64_verdef verdef;
+            memcpy(&verdef, verdef_data + vd_offset, sizeof(elf64_verdef));
+
+            // The first name is the version itself, the others are the
+            // versions it inherits from
+            uint64_t vda_offset = vd_offset + verdef.vd_aux;
+            if (verdef.vd_cnt > 0 &&
+                vda_offset + sizeof(elf64_verdaux) <= verdef_size) {
+                elf64_verdaux verdaux;
+                memcpy(&verdaux, verdef_data + vda_offset,
+                       sizeof(elf64_verdaux));
+
+                printf("-> [%u] %s%s\n", verdef.vd_ndx,
+                       (verdaux.vda_name < dynstr_size)
+                           ? dynstr + verdaux.vda_name
+                           : "",
+                       (verdef.vd_flags & VER_FLG_BASE) ? " (base)" : "");
+            }
+
+            if (verdef.vd_next == 0) {
+                break;
+            }
+            vd_offset += verdef.vd_next;
+        }
+        printf("\n\n");
+
+        free(verdef_data);
+    }
+
+    if (verneed_shdr != NULL) {
+        uint64_t verneed_size = verneed_shdr->sh_size;
+        char *verneed_data = get_sec_data_using_offset(
+            file, verneed_shdr->sh_offset, verneed_size);
+
+        printf("Symbol version requirements listed in the ELF file:\n");
+
+        uint64_t vn_offset = 0;
+        while (verneed_data != NULL &&
+               vn_offset + sizeof(elf64_verneed) <= verneed_size) {
+            elf64_verneed verneed;
+            memcpy(&verneed, verneed_data + vn_offset, sizeof(elf64_verneed));
+
+            const char *lib_name =
+                (verneed.vn_file < dynstr_size) ? dynstr + verneed.vn_file
+                                                : "";
+            uint64_t vna_offset = vn_offset + verneed.vn_aux;
+
+            for (uint16_t i = 0;
+                 i < verneed.vn_cnt &&
+                 vna_offset + sizeof(elf64_vernaux) <= verneed_size;
+                 i++) {
+                elf64_vernaux vernaux;
+                memcpy(&vernaux, verneed_data + vna_offset,
+                       sizeof(elf64_vernaux));
+
+                printf("-> [%u] %s from %s\n", vernaux.vna_other,
+                       (vernaux.vna_name < dynstr_size)
+                           ? dynstr + vernaux.vna_name
+                           : "",
+                       lib_name);
+
+                if (vernaux.vna_next == 0) {
+                    break;
+                }
+                vna_offset += vernaux.vna_next;
+            }
+
+            if (verneed.vn_next == 0) {
+                break;
+            }
+            vn_offset += verneed.vn_next;
+        }
+        printf("\n\n");
+
+        free(verneed_data);
+    }
+
+    free(dynstr);
 }
 
-// Parse all the 64-bit ELF section headers
-elf64_shdr *parse_elf64_shdrs(FILE *file, const elf64_hdr *file_hdr) {
-    elf64_shdr *sec_hdr_arr = malloc(file_hdr->e_shnum * sizeof(elf64_shdr));
+// Get the NUL-terminated string table that a section header links to
+char *get_linked_strtab(FILE *file, const elf64_shdr *sec_hdr_arr,
+                        uint64_t num_sec, const elf64_shdr *sec_hdr,
+                        uint64_t *strtab_size) {
+    return get_strtab_using_idx(file, sec_hdr_arr, num_sec, sec_hdr->sh_link,
+                                strtab_size);
+}
 
-    if (sec_hdr_arr == NULL) {
+// Get a NUL-terminated string table using its section index
+// Returns NULL if the index is out of range, the table is empty, can't be read
+// in full or its last string isn't terminated
+char *get_strtab_using_idx(FILE *file, const elf64_shdr *sec_hdr_arr,
+                           uint64_t num_sec, uint64_t strtab_idx,
+                           uint64_t *strtab_size) {
+    if (strtab_idx >= num_sec) {
         return NULL;
     }
 
-    fseek(file, file_hdr->e_shoff, SEEK_SET);
-    fread(sec_hdr_arr, sizeof(elf64_shdr), file_hdr->e_shnum, file);
+    const elf64_shdr *strtab_shdr = &(sec_hdr_arr[strtab_idx]);
 
-    return sec_hdr_arr;
-}
+    if (strtab_shdr->sh_size == 0) {
+        return NULL;
+    }
 
-// Parse all the 64-bit ELF segment (program) headers
-elf64_phdr *parse_elf64_phdrs(FILE *file, const elf64_hdr *file_hdr) {
-    elf64_phdr *prog_hdr_arr = malloc(file_hdr->e_phnum * sizeof(elf64_phdr));
+    char *strtab = get_sec_data_using_offset(file, strtab_shdr->sh_offset,
+                                             strtab_shdr->sh_size);
 
-    if (prog_hdr_arr == NULL) {
+    // Every string offset is checked against the size, so a terminated last
+    // string is enough to keep all lookups inside the buffer
+    if (strtab != NULL && strtab[strtab_shdr->sh_size - 1] != '\0') {
+        free(strtab);
         return NULL;
     }
 
-    fseek(file, file_hdr->e_phoff, SEEK_SET);
-    fread(prog_hdr_arr, sizeof(elf64_phdr), file_hdr->e_phnum, file);
+    *strtab_size = strtab_shdr->sh_size;
+    return strtab;
+}
 
-    return prog_hdr_arr;
+// Get the first section header of a type
+const elf64_shdr *get_sec_hdr_using_type(const elf64_shdr *sec_hdr_arr,
+                                         uint64_t num_sec, uint32_t sec_type) {
+    for (uint64_t i = 0; i < num_sec; i++) {
+        if (sec_hdr_arr[i].sh_type == sec_type) {
+            return &(sec_hdr_arr[i]);
+        }
+    }
+
+    return NULL;
 }
 
-// Print the names and locations of dynamically loaded
-// libraries/dependencies
-void print_dynamic_deps(FILE *file, const elf64_hdr *file_hdr,
-                        const elf64_shdr *sec_hdr_arr) {
-    // Get the '.dynamic' section header
-    const elf64_shdr *dyn_shdr =
-        get_sec_hdr_using_name(file, sec_hdr_arr, file_hdr, ".dynamic");
+// Split a version name like "GLIBC_2.2.5" into the length of its prefix
+// ("GLIBC") and a key that orders versions numerically (up to 4 components of
+// 16 bits each)
+// Returns false for names that aren't numbered, like "GLIBC_PRIVATE"
+bool parse_version_name(const char *version_name, size_t *prefix_len,
+                        uint64_t *version_key) {
+    const char *sep = strrchr(version_name, '_');
 
-    if (dyn_shdr == NULL) {
-        printf("NOTE: No dynamic section was found.\n\n");
-        return;
+    if (sep == NULL || sep == version_name) {
+        return false;
     }
 
-    // Get the 'elf64_dyn' entries in the '.dynamic' section
-    uint64_t dyn_sec_offset = dyn_shdr->sh_offset;
-    uint64_t dyn_sec_size = dyn_shdr->sh_size;
-    uint64_t dyn_ent_size = dyn_shdr->sh_entsize;
-    int dyn_ent_num = dyn_sec_size / dyn_ent_size;
+    const char *char_ptr = sep + 1;
+    uint64_t key = 0;
+    for (int num_parts = 0;; num_parts++) {
+        if (num_parts == 4 || *char_ptr < '0' || *char_ptr > '9') {
+            return false;
+        }
 
-    elf64_dyn *dyn_ent_arr = malloc(dyn_ent_num * sizeof(elf64_dyn));
+        uint64_t part = 0;
+        while (*char_ptr >= '0' && *char_ptr <= '9') {
+            part = (part * 10) + (*char_ptr - '0');
 
-    if (dyn_ent_arr == NULL) {
-        free((void *)dyn_shdr);
-        printf("NOTE: No memory could be allocated for dynamic section "
-               "entries.\n\n");
-        return;
+            if (part > 0xffff) {
+                return false;
+            }
+
+            char_ptr++;
+        }
+
+        key |= part << (48 - (16 * num_parts));
+
+        if (*char_ptr == '\0') {
+            break;
+        } else if (*char_ptr != '.') {
+            return false;
+        }
+
+        char_ptr++;
     }
 
-    fseek(file, dyn_sec_offset, SEEK_SET);
-    fread(dyn_ent_arr, sizeof(elf64_dyn), dyn_ent_num, file);
+    *prefix_len = sep - version_name;
+    *version_key = key;
+    return true;
+}
 
-    // Get the contents of the '.dynstr' section
-    char *dynstr_sec_data =
-        get_sec_data_using_name(file, sec_hdr_arr, file_hdr, ".dynstr");
+// Add an "at most this version" rule to the policy
+bool add_version_rule(elf64_version_policy *policy,
+                      const char *max_version_name) {
+    if (policy->num_rules == MAX_VERSION_RULES) {
+        return false;
+    }
 
-    if (dynstr_sec_data == NULL) {
-        free((void *)dyn_shdr);
-        free(dyn_ent_arr);
-        printf("NOTE: No dynamic section was found.\n\n");
-        return;
+    elf64_version_rule *rule = &(policy->rule_arr[policy->num_rules]);
+
+    if (!parse_version_name(max_version_name, &(rule->prefix_len),
+                            &(rule->max_version_key))) {
+        return false;
     }
 
-    // Print the library names
-    printf("Dynamic dependencies listed in the ELF file:\n");
-    for (int i = 0; i < dyn_ent_num; i++) {
-        elf64_dyn dyn_ent = dyn_ent_arr[i];
+    rule->max_version_name = strdup(max_version_name);
 
-        if (dyn_ent.d_tag == 1) {
-            uint64_t str_tab_offset = dyn_ent.d_val;
+    if (rule->max_version_name == NULL) {
+        return false;
+    }
 
-            printf("-> %s\n", (dynstr_sec_data + str_tab_offset));
+    policy->num_rules++;
+    return true;
+}
+
+// Look up a version name, adding it if it hasn't been seen yet
+// Names are hashed with the ELF hash the linker already stored next to them,
+// and each distinct name is matched against the rules only once, so checking
+// a requirement is an integer comparison. The returned entry is only valid
+// until the next call.
+const elf64_version_entry *intern_version_name(elf64_version_policy *policy,
+                                               uint32_t hash,
+                                               const char *name) {
+    // Keep the table at most half full
+    if ((policy->num_entries + 1) * 2 > policy->entry_cap) {
+        uint64_t new_cap = (policy->entry_cap > 0) ? policy->entry_cap * 2 : 64;
+        elf64_version_entry *new_entry_arr =
+            calloc(new_cap, sizeof(elf64_version_entry));
+
+        if (new_entry_arr == NULL) {
+            return NULL;
+        }
+
+        for (uint64_t i = 0; i < policy->entry_cap; i++) {
+            if (policy->entry_arr[i].name == NULL) {
+                continue;
+            }
+
+            uint64_t slot = policy->entry_arr[i].hash & (new_cap - 1);
+            while (new_entry_arr[slot].name != NULL) {
+                slot = (slot + 1) & (new_cap - 1);
+            }
+            new_entry_arr[slot] = policy->entry_arr[i];
         }
+
+        free(policy->entry_arr);
+        policy->entry_arr = new_entry_arr;
+        policy->entry_cap = new_cap;
     }
-    printf("\n");
-    printf("NOTE: Each dependency might have its own dependencies.\n");
-    printf("\n\n");
 
-    // Cleanup
-    free(dyn_ent_arr);
-    free(dynstr_sec_data);
-}
+    uint64_t slot = hash & (policy->entry_cap - 1);
+    while (policy->entry_arr[slot].name != NULL) {
+        const elf64_version_entry *entry = &(policy->entry_arr[slot]);
 
-// Get the section header string table contents
-char *get_shstrtab(FILE *file, const elf64_hdr *file_hdr) {
-    if (file_hdr->e_shstrndx == SHN_UNDEF) {
-        printf("NOTE: Empty section name string table.\n\n");
+        if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+
+        slot = (slot + 1) & (policy->entry_cap - 1);
+    }
+
+    // First time this name is seen: decode it and find its rule
+    elf64_version_entry *entry = &(policy->entry_arr[slot]);
+
+    entry->name = strdup(name);
+
+    if (entry->name == NULL) {
         return NULL;
     }
 
-    uint32_t shstrndx;
-    if (file_hdr->e_shstrndx != SHN_XINDEX) {
-        shstrndx = file_hdr->e_shstrndx;
-    } else {
-        // file_hdr->e_shstrndx == SHN_XINDEX implies that the actual index
-        // value is stored elsewhere, which in this case is the first section
-        // header's sh_link member as per the standard
+    entry->hash = hash;
+    entry->rule_idx = -1;
+    entry->version_key = 0;
 
-        elf64_shdr *first_sec_hdr = (elf64_shdr *)malloc(sizeof(elf64_shdr));
+    size_t prefix_len;
+    uint64_t version_key;
+    if (parse_version_name(name, &prefix_len, &version_key)) {
+        for (int i = 0; i < policy->num_rules; i++) {
+            const elf64_version_rule *rule = &(policy->rule_arr[i]);
 
-        if (first_sec_hdr == NULL) {
-            printf("NOTE: Couldn't allocate memory to set 'shstrndx'.\n\n");
-            return NULL;
+            if (rule->prefix_len == prefix_len &&
+                memcmp(rule->max_version_name, name, prefix_len) == 0) {
+                entry->rule_idx = i;
+                entry->version_key = version_key;
+                break;
+            }
         }
+    }
 
-        fseek(file, file_hdr->e_shoff, SEEK_SET);
-        fread(first_sec_hdr, sizeof(elf64_shdr), 1, file);
+    policy->num_entries++;
+    return entry;
+}
+
+// Free everything the command line options own
+void free_pelf_options(pelf_options *options) {
+    free(options->search_pattern);
+    free_version_policy(&(options->version_policy));
+}
+
+// Free everything a version policy owns
+void free_version_policy(elf64_version_policy *policy) {
+    for (int i = 0; i < policy->num_rules; i++) {
+        free(policy->rule_arr[i].max_version_name);
+    }
+
+    for (uint64_t i = 0; i < policy->entry_cap; i++) {
+        free(policy->entry_arr[i].name);
+    }
 
-        shstrndx = first_sec_hdr->sh_link;
+    free(policy->entry_arr);
+}
 
-        free(first_sec_hdr);
+// Get the section header string table contents
+char *get_shstrtab(FILE *file, const elf64_hdr *file_hdr) {
+    if (file_hdr->e_shstrndx == SHN_UNDEF) {
+        printf("NOTE: Empty section name string table.\n\n");
+        return NULL;
     }
 
+    uint32_t shstrndx = get_shstrndx(file, file_hdr);
+
     elf64_shdr *shstrtab_sec_hdr = (elf64_shdr *)malloc(sizeof(elf64_shdr));
 
     if (shstrtab_sec_hdr == NULL) {
@@ -294,8 +2478,13 @@ const elf64_shdr *get_sec_hdr_using_name(FILE *file,
                                          const elf64_hdr *file_hdr,
                                          char *sec_name) {
     char *shstrtab = get_shstrtab(file, file_hdr);
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+
+    if (shstrtab == NULL) {
+        return NULL;
+    }
 
-    for (int i = 0; i < file_hdr->e_shnum; i++) {
+    for (uint64_t i = 0; i < num_sec; i++) {
         const elf64_shdr sec_hdr = sec_hdr_arr[i];
         char *curr_sec_name = shstrtab + sec_hdr.sh_name;
 
@@ -313,8 +2502,13 @@ const elf64_shdr *get_sec_hdr_using_name(FILE *file,
 char *get_sec_data_using_name(FILE *file, const elf64_shdr *sec_hdr_arr,
                               const elf64_hdr *file_hdr, char *sec_name) {
     char *shstrtab = get_shstrtab(file, file_hdr);
+    uint64_t num_sec = get_num_sec(file, file_hdr);
+
+    if (shstrtab == NULL) {
+        return NULL;
+    }
 
-    for (int i = 0; i < file_hdr->e_shnum; i++) {
+    for (uint64_t i = 0; i < num_sec; i++) {
         const elf64_shdr sec_hdr = sec_hdr_arr[i];
         char *curr_sec_name = shstrtab + sec_hdr.sh_name;
 
@@ -339,13 +2533,20 @@ char *get_sec_data_using_offset(FILE *file, uint64_t file_offset,
     }
 
     fseek(file, file_offset, SEEK_SET);
-    fread(sec_data, sec_data_size, 1, file);
+    if (fread(sec_data, 1, sec_data_size, file) != sec_data_size) {
+        free(sec_data);
+        return NULL;
+    }
 
     return sec_data;
 }
 
 // Print the 64-bit ELF file header
-void print_elf64_hdr(const elf64_hdr *file_hdr) {
+// The section and segment counts and the string table index are the resolved
+// ones (see get_num_sec(), get_num_seg() and get_shstrndx()), printed next to
+// the header's own values when extended numbering is used
+void print_elf64_hdr(const elf64_hdr *file_hdr, uint64_t num_sec,
+                     uint32_t num_seg, uint32_t shstrndx) {
     printf("ELF File 'File Header':\n\n");
 
     if (file_hdr == NULL) {
@@ -373,17 +2574,29 @@ void print_elf64_hdr(const elf64_hdr *file_hdr) {
     printf("-> Flags: %#x\n", file_hdr->e_flags);
     printf("-> This header's size: %d B\n", file_hdr->e_ehsize);
     printf("-> Program (segment) header size: %d B\n", file_hdr->e_phentsize);
-    printf("-> No. of program (segment) headers: %d\n", file_hdr->e_phnum);
+    printf("-> No. of program (segment) headers: %d", file_hdr->e_phnum);
+    if (num_seg != file_hdr->e_phnum) {
+        printf(" (%u)", num_seg);
+    }
+    printf("\n");
     printf("-> Section header size: %d B\n", file_hdr->e_shentsize);
-    printf("-> No. of section headers: %d\n", file_hdr->e_shnum);
+    printf("-> No. of section headers: %d", file_hdr->e_shnum);
+    if (num_sec != file_hdr->e_shnum) {
+        printf(" (%lu)", num_sec);
+    }
+    printf("\n");
     printf("-> Index of the 'section name string table' section header in the "
-           "section header table: %d\n",
+           "section header table: %d",
            file_hdr->e_shstrndx);
+    if (shstrndx != file_hdr->e_shstrndx) {
+        printf(" (%u)", shstrndx);
+    }
+    printf("\n");
     printf("\n\n");
 }
 
 // Print all the 64-bit ELF section headers
-void print_elf64_shdrs(const elf64_shdr *sec_hdr_arr, uint16_t num_sec,
+void print_elf64_shdrs(const elf64_shdr *sec_hdr_arr, uint64_t num_sec,
                        char *shstrtab) {
     printf("ELF File Section Headers:\n\n");
 
@@ -398,13 +2611,13 @@ void print_elf64_shdrs(const elf64_shdr *sec_hdr_arr, uint16_t num_sec,
     printf("---------------------------------------------------------------"
            "------\n");
 
-    for (int i = 0; i < num_sec; i++) {
+    for (uint64_t i = 0; i < num_sec; i++) {
         const elf64_shdr sec_hdr = sec_hdr_arr[i];
         char *sec_type_name = get_sec_type_name(sec_hdr.sh_type);
         char *sec_flag_str = get_flag_str(sec_hdr.sh_flags, SEC_FLAG_VAL,
                                           SEC_FLAG_STR, NUM_SEC_FLAGS);
 
-        printf("[%d]\t", i);
+        printf("[%lu]\t", i);
         printf("%s", (shstrtab + sec_hdr.sh_name));
 
         printf("\n\t");
@@ -449,8 +2662,7 @@ void print_elf64_shdrs(const elf64_shdr *sec_hdr_arr, uint16_t num_sec,
 }
 
 // Print all the 64-bit ELF segment (program) headers
-void print_elf64_phdrs(const elf64_phdr *prog_hdr_arr,
-                       const elf64_hdr *file_hdr) {
+void print_elf64_phdrs(const elf64_phdr *prog_hdr_arr, uint32_t num_seg) {
     printf("ELF File Segment (Program) Headers:\n\n");
 
     if (prog_hdr_arr == NULL) {
@@ -463,7 +2675,7 @@ void print_elf64_phdrs(const elf64_phdr *prog_hdr_arr,
     printf("---------------------------------------------------------------"
            "------\n");
 
-    for (int i = 0; i < file_hdr->e_phnum; i++) {
+    for (uint32_t i = 0; i < num_seg; i++) {
         const elf64_phdr prog_hdr = prog_hdr_arr[i];
         char *seg_type_name = get_seg_type_name(prog_hdr.p_type);
         char *seg_flag_str = get_flag_str(prog_hdr.p_flags, SEG_FLAG_VAL,
@@ -629,6 +2841,18 @@ char *get_seg_type_name(uint32_t p_type) {
     case 0x7:
         return "TLS";
         break;
+    case 0x6474e550:
+        return "GNU_EH_FRAME";
+        break;
+    case PT_GNU_STACK:
+        return "GNU_STACK";
+        break;
+    case PT_GNU_RELRO:
+        return "GNU_RELRO";
+        break;
+    case PT_GNU_PROPERTY:
+        return "GNU_PROPERTY";
+        break;
     default:
         return NULL;
         break;